@@ -0,0 +1,116 @@
+"""Benchmark de escalabilidade do pipeline.
+
+Gera instancias sinteticas de tamanho crescente com o gerador (gerador.cpp),
+executa o main em cada uma e le estatisticas/metricas_<instancia>.json para
+montar o tempo e o pico de memoria de cada fase em funcao do numero de vertices.
+O pico de memoria e o maior valor residente do processo durante a fase; as
+etapas rodam em sequencia (--etapas-sequenciais) para que uma fase nao inclua
+a memoria das outras, a menos que --etapas-paralelas seja informado.
+
+Uso (a partir da raiz do projeto, com ./main e ./gerador compilados):
+
+    python benchmark_escalabilidade.py --tamanhos 1000,2000,5000,10000 --tipo grade
+
+Saidas: estatisticas/escalabilidade.csv e estatisticas/escalabilidade.png.
+Quando um tamanho estoura o tempo limite, os tamanhos maiores sao pulados.
+"""
+import argparse
+import csv
+import json
+import os
+import subprocess
+import time
+
+FASES = ["leitura", "floydWarshall", "estatisticas", "salvarEstatisticas",
+         "aco", "buscaLocal", "salvarSolucao"]
+
+
+def executar(comando, tempo_limite):
+    inicio = time.perf_counter()
+    try:
+        subprocess.run(comando, check=True, timeout=tempo_limite,
+                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    except subprocess.TimeoutExpired:
+        return None
+    return time.perf_counter() - inicio
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--tamanhos", default="1000,2000,5000,10000",
+                        help="numeros de vertices separados por virgula")
+    parser.add_argument("--tipo", default="grade", choices=["grade", "geometrico"])
+    parser.add_argument("--semente", default="1")
+    parser.add_argument("--formigas", default="5")
+    parser.add_argument("--iteracoes", default="5")
+    parser.add_argument("--threads", default=str(os.cpu_count() or 1))
+    parser.add_argument("--tempo-limite", type=float, default=1800.0,
+                        help="tempo maximo (s) de cada execucao do main")
+    parser.add_argument("--main", default="./main")
+    parser.add_argument("--gerador", default="./gerador")
+    parser.add_argument("--extra-gerador", default="",
+                        help="opcoes adicionais repassadas ao gerador")
+    parser.add_argument("--etapas-paralelas", action="store_true",
+                        help="mantem estatisticas e solucao em paralelo (pico de memoria do processo todo)")
+    args = parser.parse_args()
+
+    os.makedirs("estatisticas", exist_ok=True)
+    os.makedirs("solucoes", exist_ok=True)
+    linhas = []
+    for tamanho in [int(t) for t in args.tamanhos.split(",")]:
+        nome = f"ESCALA-{args.tipo}-n{tamanho}-s{args.semente}"
+        subprocess.run([args.gerador, "--tipo", args.tipo, "--vertices", str(tamanho),
+                        "--semente", args.semente, "--nome", nome] + args.extra_gerador.split(),
+                       check=True)
+        print(f"Executando {nome}...", flush=True)
+        comando = [args.main, args.formigas, args.iteracoes, "--threads", args.threads, "--instancia", nome + ".dat"]
+        if not args.etapas_paralelas:
+            comando.append("--etapas-sequenciais")
+        tempo_total = executar(comando, args.tempo_limite)
+        if tempo_total is None:
+            print(f"  tempo limite de {args.tempo_limite:.0f} s excedido; tamanhos maiores pulados")
+            linhas.append({"instancia": nome, "vertices": tamanho, "status": "tempo_limite"})
+            break
+
+        with open(f"estatisticas/metricas_{nome}.json") as arquivo:
+            metricas = json.load(arquivo)
+        linha = {"instancia": nome, "vertices": tamanho, "status": "ok", "totalS": round(tempo_total, 3)}
+        for fase in FASES:
+            linha[fase + "S"] = metricas["fasesNs"][fase] / 1e9
+            linha[fase + "Mb"] = metricas["memoriaPicoKb"][fase] / 1024
+        linhas.append(linha)
+        print(f"  {tempo_total:.2f} s, pico de memoria {max(linha[f + 'Mb'] for f in FASES):.1f} MB")
+
+    colunas = ["instancia", "vertices", "status", "totalS"] + \
+              [fase + "S" for fase in FASES] + [fase + "Mb" for fase in FASES]
+    with open("estatisticas/escalabilidade.csv", "w", newline="") as arquivo:
+        escritor = csv.DictWriter(arquivo, fieldnames=colunas)
+        escritor.writeheader()
+        escritor.writerows(linhas)
+
+    concluidas = [linha for linha in linhas if linha["status"] == "ok"]
+    if not concluidas:
+        return
+    try:
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print("matplotlib indisponivel; resultados apenas em estatisticas/escalabilidade.csv")
+        return
+    vertices = [linha["vertices"] for linha in concluidas]
+    figura, (eixo_tempo, eixo_memoria) = plt.subplots(1, 2, figsize=(13, 5))
+    for fase in FASES:
+        eixo_tempo.plot(vertices, [max(linha[fase + "S"], 1e-6) for linha in concluidas], marker="o", label=fase)
+        eixo_memoria.plot(vertices, [linha[fase + "Mb"] for linha in concluidas], marker="o", label=fase)
+    eixo_tempo.set(xscale="log", yscale="log", xlabel="vertices", ylabel="tempo (s)", title="Tempo por fase")
+    eixo_memoria.set(xscale="log", xlabel="vertices", ylabel="pico de memoria (MB)",
+                     title="Pico de memoria residente durante cada fase")
+    eixo_tempo.legend()
+    eixo_tempo.grid(True, which="both", alpha=0.3)
+    eixo_memoria.grid(True, which="both", alpha=0.3)
+    figura.tight_layout()
+    figura.savefig("estatisticas/escalabilidade.png", dpi=120)
+    print("Resultados em estatisticas/escalabilidade.csv e estatisticas/escalabilidade.png")
+
+
+if __name__ == "__main__":
+    main()
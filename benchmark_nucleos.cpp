@@ -0,0 +1,301 @@
+#include "grafo.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include "leitura.cpp"
+#include "caminhos_minimos.cpp"
+#include "colonia_formigas.cpp"
+#include "metricas.cpp"
+#include "rastreamento.cpp"
+
+using namespace std;
+
+// Microbenchmarks dos nucleos quentes do resolvedor, um por instancia
+// representativa de cada familia. Cada nucleo passa por um aquecimento, que
+// tambem calibra quantas operacoes cabem em uma repeticao, e depois por
+// varias repeticoes cronometradas; o relatorio traz media, desvio padrao e
+// minimo do tempo por operacao e a vazao em itens por segundo.
+//
+//   g++ -O2 -pthread benchmark_nucleos.cpp -o benchmark_nucleos
+//   ./benchmark_nucleos [--repeticoes N] [--tempo-ms T] [--aquecimento-ms T]
+//                       [--instancia ARQUIVO]... [--filtro TEXTO] [--csv ARQUIVO]
+
+const vector<string> vsInstanciasRepresentativas = {
+    "BHW10.dat", "CBMix12.dat", "mggdb_0.25_10.dat", "mgval_0.50_10A.dat", "DI-NEARP-n240-Q4k.dat"
+};
+
+struct sConfiguracaoBenchmark {
+    int iRepeticoes = 10;
+    double dTempoRepeticaoMs = 50.0;
+    double dAquecimentoMs = 100.0;
+    string sFiltro;       // so roda os nucleos cujo nome contem o texto
+    string sArquivoCsv;   // opcional, para comparar execucoes
+};
+
+struct sResultadoNucleo {
+    string sNucleo, sInstancia;
+    long long lOpsPorRepeticao = 0;
+    double dMediaNs = 0.0, dDesvioNs = 0.0, dMinimoNs = 0.0;
+    double dItensPorOp = 1.0;
+    string sUnidade;
+};
+
+// Evita que o compilador descarte os resultados dos nucleos
+volatile long long lSumidouro = 0;
+
+// Mede um nucleo: op() executa uma operacao e devolve um valor qualquer
+template <typename F>
+sResultadoNucleo medirNucleo(const string& sNucleo, const string& sInstancia, double dItensPorOp, const string& sUnidade,
+                             const sConfiguracaoBenchmark& configuracao, F&& op) {
+    using relogio = chrono::steady_clock;
+    long long lAcumulado = 0;
+
+    // aquecimento (caches, preditores, arena) e calibracao
+    long long lOpsAquecimento = 0;
+    auto tInicio = relogio::now();
+    double dDecorridoNs = 0.0;
+    do {
+        lAcumulado += op();
+        lOpsAquecimento++;
+        dDecorridoNs = chrono::duration<double, nano>(relogio::now() - tInicio).count();
+    } while (dDecorridoNs < configuracao.dAquecimentoMs * 1e6);
+    long long lOps = max(1LL, (long long)(configuracao.dTempoRepeticaoMs * 1e6 / (dDecorridoNs / lOpsAquecimento)));
+
+    vector<double> vdNsPorOp;
+    for (int r = 0; r < configuracao.iRepeticoes; ++r) {
+        auto tRepeticao = relogio::now();
+        for (long long i = 0; i < lOps; ++i)
+            lAcumulado += op();
+        vdNsPorOp.push_back(chrono::duration<double, nano>(relogio::now() - tRepeticao).count() / lOps);
+    }
+    lSumidouro = lSumidouro + lAcumulado;
+
+    sResultadoNucleo resultado;
+    resultado.sNucleo = sNucleo;
+    resultado.sInstancia = sInstancia;
+    resultado.lOpsPorRepeticao = lOps;
+    resultado.dItensPorOp = dItensPorOp;
+    resultado.sUnidade = sUnidade;
+    for (double dNs : vdNsPorOp) resultado.dMediaNs += dNs;
+    resultado.dMediaNs /= vdNsPorOp.size();
+    for (double dNs : vdNsPorOp) resultado.dDesvioNs += (dNs - resultado.dMediaNs) * (dNs - resultado.dMediaNs);
+    resultado.dDesvioNs = vdNsPorOp.size() > 1 ? sqrt(resultado.dDesvioNs / (vdNsPorOp.size() - 1)) : 0.0;
+    resultado.dMinimoNs = *min_element(vdNsPorOp.begin(), vdNsPorOp.end());
+    return resultado;
+}
+
+void imprimirCabecalho() {
+    cout << left << setw(24) << "nucleo" << setw(24) << "instancia" << right << setw(10) << "ops/rep"
+         << setw(14) << "ns/op" << setw(12) << "desvio" << setw(8) << "cv%" << setw(14) << "min ns/op"
+         << setw(14) << "vazao" << "  unidade" << endl;
+}
+
+void imprimirResultado(const sResultadoNucleo& r) {
+    double dVazao = r.dItensPorOp * 1e9 / r.dMediaNs;
+    cout << left << setw(24) << r.sNucleo << setw(24) << r.sInstancia << right << setw(10) << r.lOpsPorRepeticao
+         << fixed << setprecision(1) << setw(14) << r.dMediaNs << setw(12) << r.dDesvioNs
+         << setw(8) << 100.0 * r.dDesvioNs / r.dMediaNs << setw(14) << r.dMinimoNs
+         << setprecision(3) << scientific << setw(14) << dVazao << defaultfloat << "  " << r.sUnidade << "/s" << endl;
+}
+
+// Solucao de referencia deterministica (vizinho mais proximo viavel a partir
+// do deposito), para que os nucleos de busca local vejam as mesmas rotas em
+// todas as execucoes
+sSolucaoPlanaIncumbente montarSolucaoReferencia(const sGrafo& grafo, const sTabelaServicos& tabela,
+                                               const vector<vector<int>>& vviDistancias) {
+    sSolucaoPlanaIncumbente solucao;
+    vector<char> vbAtendido(tabela.iTamanho(), 0);
+    int iRestantes = tabela.iTamanho();
+    while (iRestantes > 0) {
+        solucao.viInicioRotas.push_back((int32_t)solucao.viServicos.size());
+        int iAtual = grafo.deposito, iCarga = 0;
+        while (true) {
+            int iEscolhido = -1;
+            for (int i = 0; i < tabela.iTamanho(); ++i)
+                if (!vbAtendido[i] && iCarga + tabela[i].demanda <= grafo.capacidadeVeiculo &&
+                    (iEscolhido < 0 || vviDistancias[iAtual][tabela[i].iVertice1] < vviDistancias[iAtual][tabela[iEscolhido].iVertice1]))
+                    iEscolhido = i;
+            if (iEscolhido < 0)
+                break;
+            vbAtendido[iEscolhido] = 1;
+            iRestantes--;
+            iCarga += tabela[iEscolhido].demanda;
+            iAtual = tabela[iEscolhido].iVertice2;
+            solucao.viServicos.push_back(iEscolhido);
+        }
+        if ((int)solucao.viServicos.size() == solucao.viInicioRotas.back())
+            break; // servico maior que a capacidade: nao ha como atender
+    }
+    solucao.viInicioRotas.push_back((int32_t)solucao.viServicos.size());
+    return solucao;
+}
+
+void medirInstancia(const string& sInstancia, const sConfiguracaoBenchmark& configuracao, vector<sResultadoNucleo>& vsResultados) {
+    auto bSelecionado = [&](const string& sNucleo) {
+        return configuracao.sFiltro.empty() || sNucleo.find(configuracao.sFiltro) != string::npos;
+    };
+    auto registrar = [&](const sResultadoNucleo& resultado) {
+        imprimirResultado(resultado);
+        vsResultados.push_back(resultado);
+    };
+
+    bool bConseguiuLerArquivo = false;
+    sGrafo grafo = sLerArquivo(sInstancia, bConseguiuLerArquivo, false);
+    if (!bConseguiuLerArquivo) {
+        cerr << "Instancia ignorada: " << sInstancia << endl;
+        return;
+    }
+    int iTamanho = grafo.iNumVertices + 1;
+    vector<vector<int>> vviDistancias(iTamanho, vector<int>(iTamanho, INF)), vviPredecessores(iTamanho, vector<int>(iTamanho, -1));
+    floydWarshall(grafo, iTamanho, vviDistancias, vviPredecessores);
+
+    if (bSelecionado("sLerArquivo"))
+        registrar(medirNucleo("sLerArquivo", sInstancia, grafo.vsArestas.size() + grafo.vsArcos.size(), "ligacoes", configuracao, [&]() {
+            bool bOk = false;
+            return (long long)sLerArquivo(sInstancia, bOk, false).iNumVertices;
+        }));
+
+    if (bSelecionado("floydWarshall")) {
+        vector<vector<int>> vviDist, vviPred;
+        registrar(medirNucleo("floydWarshall", sInstancia, (double)iTamanho * iTamanho * iTamanho, "relaxacoes", configuracao, [&]() {
+            vviDist.assign(iTamanho, vector<int>(iTamanho, INF));
+            vviPred.assign(iTamanho, vector<int>(iTamanho, -1));
+            floydWarshall(grafo, iTamanho, vviDist, vviPred);
+            return (long long)vviDist[grafo.deposito][iTamanho - 1];
+        }));
+    }
+
+    const sTabelaServicos tabela = sCriarTabelaServicos(grafo);
+    sSolucaoPlanaIncumbente referenciaPlana = montarSolucaoReferencia(grafo, tabela, vviDistancias);
+    sSolucao referencia = sConverterSolucaoPlana(referenciaPlana, tabela, vviDistancias, grafo.deposito);
+    if (referencia.rotas.empty())
+        return;
+
+    if (bSelecionado("custoRota"))
+        registrar(medirNucleo("custoRota", sInstancia, tabela.iTamanho(), "servicos", configuracao, [&]() {
+            double dTotal = 0.0;
+            for (const sRota& rota : referencia.rotas)
+                dTotal += custoRota(rota.vsServicos, vviDistancias, grafo.deposito);
+            return (long long)dTotal;
+        }));
+
+    sParametrosACO parametros;
+    sFeromonioCandidatos feromonio;
+    feromonio.inicializar(tabela, vviDistancias, parametros.iVizinhosFeromonio, FEROMONIO_INICIAL);
+    if (bSelecionado("construirSolucao")) {
+        sArena arena;
+        registrar(medirNucleo("construirSolucao", sInstancia, tabela.iTamanho(), "servicos", configuracao, [&]() {
+            arena.reiniciar();
+            return (long long)construirSolucao(grafo, tabela, vviDistancias, feromonio, parametros, arena).iCustoTotal;
+        }));
+    }
+
+    // Evaporacao de todas as entradas e deposito de uma formiga (acumulo no
+    // buffer esparso e aplicacao no feromonio), como no fim de cada iteracao.
+    // O feromonio e reiniciado antes de chegar a valores subnormais, que sao
+    // bem mais lentos e nunca aparecem no ACO
+    if (bSelecionado("evaporar"))
+        registrar(medirNucleo("evaporar", sInstancia, (double)feromonio.vdValores.size(), "entradas", configuracao, [&]() {
+            if (feromonio.vdValores[0] < 1e-100)
+                feromonio.reiniciar(FEROMONIO_INICIAL);
+            feromonio.evaporar(parametros.dTaxaEvaporacao);
+            return (long long)(feromonio.vdValores[0] > 0);
+        }));
+    if (bSelecionado("depositar")) {
+        sBufferDelta delta;
+        registrar(medirNucleo("depositar", sInstancia, referenciaPlana.viServicos.size(), "ligacoes",
+                              configuracao, [&]() {
+            acumularDeposito(delta, feromonio, referenciaPlana, 1.0 / referencia.iCustoTotal);
+            delta.aplicar(feromonio);
+            return (long long)delta.viOcupadas.size();
+        }));
+    }
+
+    // Busca local intra-rota na rota mais longa; a copia da rota a cada
+    // operacao (um movimento aceito a altera) entra na medida
+    int iMaisLonga = 0, iSegundaMaisLonga = -1;
+    for (int r = 1; r < (int)referencia.rotas.size(); ++r) {
+        if (referencia.rotas[r].vsServicos.size() > referencia.rotas[iMaisLonga].vsServicos.size()) {
+            iSegundaMaisLonga = iMaisLonga;
+            iMaisLonga = r;
+        } else if (iSegundaMaisLonga < 0 || referencia.rotas[r].vsServicos.size() > referencia.rotas[iSegundaMaisLonga].vsServicos.size()) {
+            iSegundaMaisLonga = r;
+        }
+    }
+    const vector<sServico>& vsRotaLonga = referencia.rotas[iMaisLonga].vsServicos;
+    double dParesRota = (double)vsRotaLonga.size() * (vsRotaLonga.size() - 1) / 2;
+    if (bSelecionado("twoOptTrecho")) {
+        vector<sServico> vsSequencia;
+        registrar(medirNucleo("twoOptTrecho", sInstancia, dParesRota, "pares", configuracao, [&]() {
+            vsSequencia = vsRotaLonga;
+            return (long long)twoOptTrecho(vsSequencia, vviDistancias, grafo.deposito);
+        }));
+    }
+    if (bSelecionado("swapServico")) {
+        vector<sServico> vsSequencia;
+        registrar(medirNucleo("swapServico", sInstancia, dParesRota, "pares", configuracao, [&]() {
+            vsSequencia = vsRotaLonga;
+            return (long long)swapServico(vsSequencia, vviDistancias, grafo.deposito);
+        }));
+    }
+
+    // Varreduras entre as duas rotas mais longas, sem bits "nao olhar"
+    if (iSegundaMaisLonga < 0)
+        return;
+    sVisaoRota A(referencia.rotas[iMaisLonga], grafo.deposito), B(referencia.rotas[iSegundaMaisLonga], grafo.deposito);
+    vector<char> vbNaoOlhar(tabela.iTamanho() + 1, 0);
+    double dParesEntreRotas = (double)A.iTamanho() * B.iTamanho();
+    if (bSelecionado("relocateExchange"))
+        registrar(medirNucleo("relocateExchange", sInstancia, dParesEntreRotas, "pares", configuracao, [&]() {
+            sMovimento melhor;
+            avaliarRelocateExchange(A, B, iMaisLonga, iSegundaMaisLonga, vbNaoOlhar, vviDistancias, grafo.capacidadeVeiculo, melhor);
+            return (long long)melhor.iGanho;
+        }));
+    if (bSelecionado("movimentosEntreRotas"))
+        registrar(medirNucleo("movimentosEntreRotas", sInstancia, dParesEntreRotas, "pares", configuracao, [&]() {
+            return (long long)avaliarMovimentosEntreRotas(referencia, iMaisLonga, iSegundaMaisLonga, vviDistancias,
+                                                          grafo.deposito, grafo.capacidadeVeiculo).iGanho;
+        }));
+}
+
+int main(int iQtdArgumentos, char* vsArgumentos[]) {
+    sConfiguracaoBenchmark configuracao;
+    vector<string> vsInstancias;
+    for (int i = 1; i + 1 < iQtdArgumentos; i += 2) {
+        string sArgumento = vsArgumentos[i];
+        if (sArgumento == "--repeticoes") configuracao.iRepeticoes = max(1, atoi(vsArgumentos[i + 1]));
+        else if (sArgumento == "--tempo-ms") configuracao.dTempoRepeticaoMs = atof(vsArgumentos[i + 1]);
+        else if (sArgumento == "--aquecimento-ms") configuracao.dAquecimentoMs = atof(vsArgumentos[i + 1]);
+        else if (sArgumento == "--instancia") vsInstancias.push_back(vsArgumentos[i + 1]);
+        else if (sArgumento == "--filtro") configuracao.sFiltro = vsArgumentos[i + 1];
+        else if (sArgumento == "--csv") configuracao.sArquivoCsv = vsArgumentos[i + 1];
+    }
+    if (vsInstancias.empty())
+        vsInstancias = vsInstanciasRepresentativas;
+
+    cout << "Repeticoes: " << configuracao.iRepeticoes << " x " << configuracao.dTempoRepeticaoMs
+         << " ms (aquecimento " << configuracao.dAquecimentoMs << " ms)" << endl;
+    imprimirCabecalho();
+    vector<sResultadoNucleo> vsResultados;
+    for (const string& sInstancia : vsInstancias)
+        medirInstancia(sInstancia, configuracao, vsResultados);
+
+    if (!configuracao.sArquivoCsv.empty()) {
+        ofstream arquivoCsv(configuracao.sArquivoCsv);
+        if (!arquivoCsv.is_open()) {
+            cerr << "Erro ao criar " << configuracao.sArquivoCsv << endl;
+            return 1;
+        }
+        arquivoCsv << "nucleo,instancia,ops_por_repeticao,ns_por_op,desvio_ns,minimo_ns,itens_por_segundo,unidade\n";
+        for (const sResultadoNucleo& r : vsResultados)
+            arquivoCsv << r.sNucleo << "," << r.sInstancia << "," << r.lOpsPorRepeticao << "," << r.dMediaNs << ","
+                       << r.dDesvioNs << "," << r.dMinimoNs << "," << r.dItensPorOp * 1e9 / r.dMediaNs << "," << r.sUnidade << "\n";
+    }
+    return 0;
+}
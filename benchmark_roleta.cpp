@@ -0,0 +1,123 @@
+#include "roleta.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+// Microbenchmark do passo da roleta de construirSolucao: calculo dos pesos dos
+// servicos pendentes e escolha pela soma de prefixos, para cada nivel de SIMD
+// suportado pela CPU e varias quantidades de candidatos.
+//
+//   g++ -O2 benchmark_roleta.cpp -o benchmark_roleta
+//   ./benchmark_roleta [--passos N] [--alfa A] [--beta B]
+
+struct sCenario {
+    vector<int32_t> viVertice1, viDemanda, viCustoFixo;
+    vector<int> viDistancias;
+    vector<double> vdFeromonio;
+    vector<double> vdRoletas; // fracoes sorteadas de antemao, iguais para todos os niveis
+};
+
+sCenario criarCenario(int iQuantidade, int iNumVertices, int iNumPassos, mt19937& gen) {
+    sCenario cenario;
+    uniform_int_distribution<int> vertice(0, iNumVertices - 1), custo(1, 1000), demanda(1, 100);
+    uniform_real_distribution<double> feromonio(0.05, 2.0), fracao(0.0, 1.0);
+    for (int p = 0; p < iQuantidade; ++p) {
+        cenario.viVertice1.push_back(vertice(gen));
+        cenario.viDemanda.push_back(demanda(gen));
+        cenario.viCustoFixo.push_back(custo(gen));
+    }
+    for (int v = 0; v < iNumVertices; ++v) {
+        cenario.viDistancias.push_back(custo(gen));
+        cenario.vdFeromonio.push_back(feromonio(gen));
+    }
+    for (int i = 0; i < iNumPassos; ++i)
+        cenario.vdRoletas.push_back(1.0 - fracao(gen));
+    return cenario;
+}
+
+int main(int iQtdArgumentos, char* vsArgumentos[]) {
+    int iNumPassos = 20000;
+    double dAlfa = 1.0, dBeta = 3.0;
+    for (int i = 1; i + 1 < iQtdArgumentos; i += 2) {
+        string sArgumento = vsArgumentos[i];
+        if (sArgumento == "--passos") iNumPassos = atoi(vsArgumentos[i + 1]);
+        else if (sArgumento == "--alfa") dAlfa = atof(vsArgumentos[i + 1]);
+        else if (sArgumento == "--beta") dBeta = atof(vsArgumentos[i + 1]);
+    }
+
+    eNivelSimd nivelMaximo = nivelSimdDisponivel();
+    cout << "Nivel SIMD da CPU: " << sNomeNivelSimd(nivelMaximo) << " | alfa " << dAlfa << " beta " << dBeta << endl;
+    cout << setw(12) << "candidatos" << setw(10) << "nivel" << setw(12) << "ns pesos" << setw(12) << "ns escolha"
+         << setw(12) << "ns/passo" << setw(14) << "ns/candidato" << setw(10) << "speedup" << setw(14) << "divergencias" << endl;
+
+    mt19937 gen(42);
+    for (int iQuantidade : {16, 64, 256, 1024, 4096}) {
+        sCenario cenario = criarCenario(iQuantidade, 2000, iNumPassos, gen);
+        sEntradaRoleta entrada;
+        entrada.piVertice1 = cenario.viVertice1.data();
+        entrada.piChaveFeromonio = cenario.viVertice1.data();
+        entrada.piDemanda = cenario.viDemanda.data();
+        entrada.piCustoFixo = cenario.viCustoFixo.data();
+        entrada.iQuantidade = iQuantidade;
+        entrada.piDistanciasAtual = cenario.viDistancias.data();
+        entrada.pdFeromonioAtual = cenario.vdFeromonio.data();
+        entrada.iCapacidadeRestante = 70; // ~70% dos servicos cabem
+        entrada.dAlfa = dAlfa;
+        entrada.dBeta = dBeta;
+
+        vector<double> vdPesos(iQuantidade);
+        vector<int> viEscolhasEscalar;
+        double dNsEscalar = 0.0;
+        for (int iNivel = SIMD_ESCALAR; iNivel <= nivelMaximo; ++iNivel) {
+            sNucleosRoleta nucleos = nucleosRoleta((eNivelSimd)iNivel);
+            vector<int> viEscolhas(iNumPassos);
+            int iNumCandidatos = 0;
+            // aquecimento
+            for (int i = 0; i < 100; ++i)
+                nucleos.escolher(vdPesos.data(), iQuantidade, nucleos.calcularPesos(entrada, vdPesos.data(), iNumCandidatos) * 0.5);
+
+            // passo completo, e depois cada nucleo isolado
+            auto tInicio = chrono::steady_clock::now();
+            double dSoma = 0.0;
+            for (int i = 0; i < iNumPassos; ++i) {
+                dSoma = nucleos.calcularPesos(entrada, vdPesos.data(), iNumCandidatos);
+                viEscolhas[i] = nucleos.escolher(vdPesos.data(), iQuantidade, cenario.vdRoletas[i] * dSoma);
+            }
+            auto tPassos = chrono::steady_clock::now();
+            double dSomaPesos = 0.0;
+            for (int i = 0; i < iNumPassos; ++i)
+                dSomaPesos += nucleos.calcularPesos(entrada, vdPesos.data(), iNumCandidatos);
+            auto tPesos = chrono::steady_clock::now();
+            long long lSomaEscolhas = 0;
+            for (int i = 0; i < iNumPassos; ++i)
+                lSomaEscolhas += nucleos.escolher(vdPesos.data(), iQuantidade, cenario.vdRoletas[i] * dSoma);
+            auto tEscolhas = chrono::steady_clock::now();
+            if (dSomaPesos < 0 || lSomaEscolhas < -iNumPassos) // mantem os resultados vivos
+                cout << "";
+            double dNs = chrono::duration<double, nano>(tPassos - tInicio).count() / iNumPassos;
+            double dNsPesos = chrono::duration<double, nano>(tPesos - tPassos).count() / iNumPassos;
+            double dNsEscolha = chrono::duration<double, nano>(tEscolhas - tPesos).count() / iNumPassos;
+
+            // escolhas diferentes da versao escalar (so por arredondamento na fronteira)
+            int iDivergencias = 0;
+            if (iNivel == SIMD_ESCALAR) {
+                viEscolhasEscalar = viEscolhas;
+                dNsEscalar = dNs;
+            } else {
+                for (int i = 0; i < iNumPassos; ++i)
+                    iDivergencias += viEscolhas[i] != viEscolhasEscalar[i];
+            }
+            cout << setw(12) << iQuantidade << setw(10) << sNomeNivelSimd((eNivelSimd)iNivel) << fixed << setprecision(1)
+                 << setw(12) << dNsPesos << setw(12) << dNsEscolha << setw(12) << dNs
+                 << setw(14) << setprecision(2) << dNs / iQuantidade
+                 << setw(9) << dNsEscalar / dNs << "x" << setw(14) << iDivergencias << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "grafo.hpp"
+#include "solucao.hpp"
+#include "biblioteca.hpp"
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <memory>
+#include "leitura.cpp"
+#include "caminhos_minimos.cpp"
+#include "estatisticas.cpp"
+#include "colonia_formigas.cpp"
+#include "limitantes.cpp"
+#include "metricas.cpp"
+#include "rastreamento.cpp"
+#include "cache_preprocessamento.cpp"
+#include "leitura_solucao.cpp"
+#include "reotimizacao.cpp"
+
+using namespace std;
+
+// Confere se os indices de vertices da instancia estao dentro do grafo, para
+// que um buffer malformado nao leve a acessos fora das matrizes
+bool bValidarGrafo(const sGrafo& grafo, string& sErro) {
+    if (grafo.iNumVertices <= 0) {
+        sErro = "instancia sem vertices";
+        return false;
+    }
+    auto bVerticeValido = [&](int v) { return v >= 1 && v <= grafo.iNumVertices; };
+    if (!bVerticeValido(grafo.deposito)) {
+        sErro = "deposito fora do grafo";
+        return false;
+    }
+    if (grafo.capacidadeVeiculo <= 0) {
+        sErro = "capacidade dos veiculos invalida";
+        return false;
+    }
+    for (const auto& vertice : grafo.vsVertices)
+        if (!bVerticeValido(vertice.id) || vertice.demanda > grafo.capacidadeVeiculo) {
+            sErro = "vertice requerido invalido: N" + to_string(vertice.id);
+            return false;
+        }
+    for (const auto& aresta : grafo.vsArestas)
+        if (!bVerticeValido(aresta.origem) || !bVerticeValido(aresta.destino) || aresta.demanda > grafo.capacidadeVeiculo) {
+            sErro = "aresta invalida: E" + to_string(aresta.id);
+            return false;
+        }
+    for (const auto& arco : grafo.vsArcos)
+        if (!bVerticeValido(arco.origem) || !bVerticeValido(arco.destino) || arco.demanda > grafo.capacidadeVeiculo) {
+            sErro = "arco invalido: A" + to_string(arco.id);
+            return false;
+        }
+    return true;
+}
+
+shared_ptr<const sPreprocessamento> pPreprocessar(const sGrafo& grafo) {
+    auto preprocessamento = make_shared<sPreprocessamento>();
+    preprocessamento->iHashTopologia = iHashTopologia(grafo);
+    int iTamanho = grafo.iNumVertices + 1;
+    preprocessamento->vviDistancias.assign(iTamanho, vector<int>(iTamanho, INF));
+    preprocessamento->vviPredecessores.assign(iTamanho, vector<int>(iTamanho, -1));
+    floydWarshall(grafo, iTamanho, preprocessamento->vviDistancias, preprocessamento->vviPredecessores);
+    return preprocessamento;
+}
+
+// O grafo deve ter sido validado (bValidarGrafo) e o pre-processamento deve ser
+// da mesma topologia
+sResultadoResolvedor resolverPreprocessado(const sGrafo& grafo, const sPreprocessamento& preprocessamento,
+                                           const sOpcoesResolvedor& opcoes) {
+    sResultadoResolvedor resultado;
+    resultado.grafo = grafo;
+    const vector<vector<int>>& vviDistancias = preprocessamento.vviDistancias;
+
+    auto tInicio = chrono::steady_clock::now();
+    resultado.limitante = sCalcularLimitanteInferior(grafo, vviDistancias);
+    if (opcoes.bCalcularEstatisticas) {
+        sEstatisticasGrafo& estatisticas = resultado.estatisticas;
+        estatisticas.dDensidade = dCalcularDensidade(grafo.iNumVertices, grafo.vsArestas.size(), grafo.vsArcos.size(), !grafo.vsArcos.empty());
+        calcularGraus(grafo, grafo.iNumVertices, estatisticas.iGrauMinimo, estatisticas.iGrauMaximo);
+        estatisticas.iComponentesConectados = iCalcularComponentesConectados(grafo, grafo.iNumVertices);
+        pair<double, int> parCaminhoMedioDiametro = calcularCaminhoMedioDiametro(vviDistancias, grafo.iNumVertices);
+        estatisticas.dCaminhoMedio = parCaminhoMedioDiametro.first;
+        estatisticas.iDiametro = parCaminhoMedioDiametro.second;
+        estatisticas.viIntermediacoes = viCalcularIntermediacoes(preprocessamento.vviPredecessores, vviDistancias, grafo.iNumVertices);
+    }
+    auto tPreprocessado = chrono::steady_clock::now();
+    resultado.dSegundosPreprocessamento = chrono::duration<double>(tPreprocessado - tInicio).count();
+
+    sParametrosACO parametros = opcoes.parametrosACO;
+    parametros.bExibirProgresso = false;
+    parametros.pCancelamento = opcoes.pCancelamento;
+    parametros.iLimitanteInferior = resultado.limitante.iValor;
+    resultado.solucao = executarACO(grafo, vviDistancias, parametros);
+    if (opcoes.bBuscaLocal) {
+        sOpcoesBuscaLocal opcoesBusca;
+        opcoesBusca.pCancelamento = opcoes.pCancelamento;
+        buscaLocal(resultado.solucao, vviDistancias, grafo.deposito, grafo.capacidadeVeiculo, opcoesBusca);
+    }
+    resultado.dSegundosSolucao = chrono::duration<double>(chrono::steady_clock::now() - tPreprocessado).count();
+    resultado.dGap = dCalcularGap(resultado.solucao.iCustoTotal, resultado.limitante);
+    resultado.bCancelado = opcoes.pCancelamento && opcoes.pCancelamento->bCancelado();
+    resultado.bSucesso = true;
+    return resultado;
+}
+
+sResultadoResolvedor reotimizarPreprocessado(const sGrafo& grafo, const sPreprocessamento& preprocessamento,
+                                             const sSolucao& solucaoAnterior, const sDeltaServicos& delta,
+                                             const sOpcoesResolvedor& opcoes) {
+    sResultadoResolvedor resultado;
+    resultado.grafo = grafo;
+    auto tInicio = chrono::steady_clock::now();
+    resultado.limitante = sCalcularLimitanteInferior(grafo, preprocessamento.vviDistancias);
+    auto tPreprocessado = chrono::steady_clock::now();
+    resultado.dSegundosPreprocessamento = chrono::duration<double>(tPreprocessado - tInicio).count();
+
+    sOpcoesBuscaLocal opcoesBusca;
+    opcoesBusca.pCancelamento = opcoes.pCancelamento;
+    resultado.solucao = reotimizarSolucao(solucaoAnterior, delta, preprocessamento.vviDistancias, grafo.deposito,
+                                          grafo.capacidadeVeiculo, opcoesBusca);
+    resultado.dSegundosSolucao = chrono::duration<double>(chrono::steady_clock::now() - tPreprocessado).count();
+    resultado.dGap = dCalcularGap(resultado.solucao.iCustoTotal, resultado.limitante);
+    resultado.bCancelado = opcoes.pCancelamento && opcoes.pCancelamento->bCancelado();
+    resultado.bSucesso = true;
+    return resultado;
+}
+
+sResultadoResolvedor resolverGrafo(const sGrafo& grafo, const sOpcoesResolvedor& opcoes) {
+    sResultadoResolvedor resultado;
+    if (!bValidarGrafo(grafo, resultado.sErro)) {
+        resultado.grafo = grafo;
+        return resultado;
+    }
+    auto tInicio = chrono::steady_clock::now();
+    shared_ptr<const sPreprocessamento> preprocessamento = pPreprocessar(grafo);
+    double dSegundosFloydWarshall = chrono::duration<double>(chrono::steady_clock::now() - tInicio).count();
+    resultado = resolverPreprocessado(grafo, *preprocessamento, opcoes);
+    resultado.dSegundosPreprocessamento += dSegundosFloydWarshall;
+    return resultado;
+}
+
+sResultadoResolvedor resolverDat(const char* pDados, size_t iTamanho, const sOpcoesResolvedor& opcoes) {
+    istringstream entrada(string(pDados, iTamanho));
+    bool bConseguiuLer = false;
+    sGrafo grafo = sLerGrafo(entrada, "<memoria>", bConseguiuLer, false);
+    if (!bConseguiuLer) {
+        sResultadoResolvedor resultado;
+        resultado.sErro = "conteudo .dat invalido";
+        return resultado;
+    }
+    return resolverGrafo(grafo, opcoes);
+}
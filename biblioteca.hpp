@@ -0,0 +1,74 @@
+#ifndef BIBLIOTECA_HPP
+#define BIBLIOTECA_HPP
+
+#include "grafo.hpp"
+#include "solucao.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+using namespace std;
+
+// API em processo do resolvedor: recebe a instancia em memoria (sGrafo ou o
+// conteudo de um .dat), nao le nem grava arquivos e nao usa estado global, de
+// modo que varias chamadas podem rodar ao mesmo tempo em threads diferentes.
+//
+// Compilacao como biblioteca estatica:
+//   g++ -O2 -c biblioteca.cpp -o biblioteca.o && ar rcs libcarp.a biblioteca.o
+
+// Estatisticas do grafo (as mesmas gravadas em estatisticas_<instancia>.json)
+struct sEstatisticasGrafo {
+    double dDensidade = 0.0;
+    int iComponentesConectados = 0;
+    int iGrauMinimo = 0;
+    int iGrauMaximo = 0;
+    double dCaminhoMedio = 0.0;
+    int iDiametro = 0;
+    vector<int> viIntermediacoes;
+};
+
+struct sOpcoesResolvedor {
+    sParametrosACO parametrosACO;     // bExibirProgresso e pCancelamento sao ignorados
+    bool bBuscaLocal = true;          // busca local final sobre a solucao do ACO
+    bool bCalcularEstatisticas = false;
+    const sTokenCancelamento* pCancelamento = nullptr; // opcional, pode ser cancelado de outra thread
+};
+
+struct sResultadoResolvedor {
+    bool bSucesso = false;
+    bool bCancelado = false;          // a solucao e a melhor encontrada ate o cancelamento
+    string sErro;
+    sGrafo grafo;                     // instancia resolvida (util quando lida de um buffer)
+    sSolucao solucao;
+    sLimitanteInferior limitante;
+    double dGap = 0.0;
+    sEstatisticasGrafo estatisticas;  // preenchido quando bCalcularEstatisticas
+    double dSegundosPreprocessamento = 0.0;
+    double dSegundosSolucao = 0.0;
+};
+
+// Pre-processamento que depende apenas da topologia (matrizes do Floyd-Warshall).
+// Instancias com a mesma malha e servicos diferentes podem compartilha-lo.
+struct sPreprocessamento {
+    uint64_t iHashTopologia = 0;
+    vector<vector<int>> vviDistancias;
+    vector<vector<int>> vviPredecessores;
+    size_t iBytes() const { return 2 * vviDistancias.size() * vviDistancias.size() * sizeof(int); }
+};
+
+bool bValidarGrafo(const sGrafo& grafo, string& sErro);
+shared_ptr<const sPreprocessamento> pPreprocessar(const sGrafo& grafo);
+sResultadoResolvedor resolverPreprocessado(const sGrafo& grafo, const sPreprocessamento& preprocessamento,
+                                           const sOpcoesResolvedor& opcoes);
+// Reotimizacao incremental: repara a solucao anterior de acordo com o delta de
+// servicos (ids da solucao anterior) e aplica busca local so nas rotas afetadas,
+// sem rodar o ACO. O grafo ja deve refletir o delta.
+sResultadoResolvedor reotimizarPreprocessado(const sGrafo& grafo, const sPreprocessamento& preprocessamento,
+                                             const sSolucao& solucaoAnterior, const sDeltaServicos& delta,
+                                             const sOpcoesResolvedor& opcoes);
+sResultadoResolvedor resolverGrafo(const sGrafo& grafo, const sOpcoesResolvedor& opcoes);
+sResultadoResolvedor resolverDat(const char* pDados, size_t iTamanho, const sOpcoesResolvedor& opcoes);
+
+#endif
@@ -0,0 +1,100 @@
+#include "grafo.hpp"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <filesystem>
+
+using namespace std;
+
+// Cache em disco do pre-processamento (matrizes de distancias e predecessores do
+// Floyd-Warshall). Cada arquivo guarda o hash da topologia que o gerou, entao um
+// cache de uma instancia alterada e simplesmente ignorado.
+
+const string DIRETORIO_CACHE = "./cache/";
+const uint32_t ASSINATURA_CACHE = 0x32535041; // "APS2" (ligacoes paralelas: vale a mais barata)
+
+// Hash FNV-1a da topologia (vertices, arestas, arcos e custos de transito)
+uint64_t iHashTopologia(const sGrafo& grafo) {
+    uint64_t iHash = 1469598103934665603ull;
+    auto misturar = [&](int64_t iValor) {
+        for (int b = 0; b < 8; ++b) {
+            iHash ^= (uint64_t)((iValor >> (8 * b)) & 0xFF);
+            iHash *= 1099511628211ull;
+        }
+    };
+    misturar(grafo.iNumVertices);
+    misturar((int64_t)grafo.vsArestas.size());
+    for (const sAresta& aresta : grafo.vsArestas) {
+        misturar(aresta.origem);
+        misturar(aresta.destino);
+        misturar(aresta.custoTransito);
+    }
+    misturar((int64_t)grafo.vsArcos.size());
+    for (const sArco& arco : grafo.vsArcos) {
+        misturar(arco.origem);
+        misturar(arco.destino);
+        misturar(arco.custoTransito);
+    }
+    return iHash;
+}
+
+string sCaminhoCache(const sGrafo& grafo) {
+    return DIRETORIO_CACHE + grafo.nome + ".apsp";
+}
+
+bool bCarregarCachePreprocessamento(
+										const sGrafo& grafo,
+										vector<vector<int>>& vviDistancias,
+										vector<vector<int>>& vviPredecessores
+) {
+    ifstream arquivo(sCaminhoCache(grafo), ios::binary);
+    if (!arquivo.is_open())
+        return false;
+
+    uint32_t iAssinatura = 0;
+    int32_t iTamanho = 0;
+    uint64_t iHash = 0;
+    arquivo.read(reinterpret_cast<char*>(&iAssinatura), sizeof(iAssinatura));
+    arquivo.read(reinterpret_cast<char*>(&iTamanho), sizeof(iTamanho));
+    arquivo.read(reinterpret_cast<char*>(&iHash), sizeof(iHash));
+    if (!arquivo || iAssinatura != ASSINATURA_CACHE || iTamanho != grafo.iNumVertices + 1 || iHash != iHashTopologia(grafo))
+        return false;
+
+    vviDistancias.assign(iTamanho, vector<int>(iTamanho));
+    vviPredecessores.assign(iTamanho, vector<int>(iTamanho));
+    for (auto& viLinha : vviDistancias)
+        arquivo.read(reinterpret_cast<char*>(viLinha.data()), sizeof(int) * iTamanho);
+    for (auto& viLinha : vviPredecessores)
+        arquivo.read(reinterpret_cast<char*>(viLinha.data()), sizeof(int) * iTamanho);
+    return (bool)arquivo;
+}
+
+void salvarCachePreprocessamento(
+									const sGrafo& grafo,
+									const vector<vector<int>>& vviDistancias,
+									const vector<vector<int>>& vviPredecessores
+) {
+    error_code erro;
+    filesystem::create_directories(DIRETORIO_CACHE, erro);
+    // Grava em arquivo temporario e renomeia, para que leitores concorrentes
+    // nunca vejam um cache pela metade
+    string sCaminho = sCaminhoCache(grafo);
+    string sTemporario = sCaminho + ".tmp";
+    ofstream arquivo(sTemporario, ios::binary);
+    if (!arquivo.is_open())
+        return;
+
+    uint32_t iAssinatura = ASSINATURA_CACHE;
+    int32_t iTamanho = grafo.iNumVertices + 1;
+    uint64_t iHash = iHashTopologia(grafo);
+    arquivo.write(reinterpret_cast<const char*>(&iAssinatura), sizeof(iAssinatura));
+    arquivo.write(reinterpret_cast<const char*>(&iTamanho), sizeof(iTamanho));
+    arquivo.write(reinterpret_cast<const char*>(&iHash), sizeof(iHash));
+    for (const auto& viLinha : vviDistancias)
+        arquivo.write(reinterpret_cast<const char*>(viLinha.data()), sizeof(int) * iTamanho);
+    for (const auto& viLinha : vviPredecessores)
+        arquivo.write(reinterpret_cast<const char*>(viLinha.data()), sizeof(int) * iTamanho);
+    arquivo.close();
+    filesystem::rename(sTemporario, sCaminho, erro);
+}
@@ -0,0 +1,215 @@
+#include "grafo.hpp"
+#include "rastreamento.hpp"
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+using namespace std;
+
+void floydWarshall(const sGrafo& Grafo, int iTamanho, vector<vector<int>>& vviDistancias, vector<vector<int>>& vviPredecessores) {
+    RASTREAR("floydWarshall");
+    for (int i = 1; i < iTamanho; ++i) {
+        vviDistancias[i][i] = 0;
+        vviPredecessores[i][i] = i;
+    }
+    // Entre ligacoes paralelas vale a mais barata
+    auto ligar = [&](int iOrigem, int iDestino, int iCusto) {
+        if (iOrigem == iDestino || iCusto >= vviDistancias[iOrigem][iDestino])
+            return;
+        vviDistancias[iOrigem][iDestino] = iCusto;
+        vviPredecessores[iOrigem][iDestino] = iOrigem;
+    };
+    for (const sAresta& Aresta : Grafo.vsArestas) {
+        ligar(Aresta.origem, Aresta.destino, Aresta.custoTransito);
+        ligar(Aresta.destino, Aresta.origem, Aresta.custoTransito);
+    }
+    for (const sArco& Arco : Grafo.vsArcos)
+        ligar(Arco.origem, Arco.destino, Arco.custoTransito);
+    for (int k = 1; k < iTamanho; ++k) {
+        for (int i = 1; i < iTamanho; ++i) {
+            for (int j = 1; j < iTamanho; ++j) {
+                if (vviDistancias[i][k] != INF && vviDistancias[k][j] != INF && vviDistancias[i][k] + vviDistancias[k][j] < vviDistancias[i][j]) {
+                    vviDistancias[i][j] = vviDistancias[i][k] + vviDistancias[k][j];
+                    vviPredecessores[i][j] = vviPredecessores[k][j];
+                }
+            }
+        }
+    }
+}
+
+// Atualizacao dinamica das matrizes quando o custo de transito de uma ligacao
+// muda (interdicoes, tempos de viagem), sem refazer o Floyd-Warshall.
+
+// Menor custo de transito entre ligacoes diretas de iOrigem para iDestino (INF se nao houver)
+int iCustoLigacaoDireta(const sGrafo& Grafo, int iOrigem, int iDestino) {
+    int iCusto = INF;
+    for (const sAresta& Aresta : Grafo.vsArestas)
+        if ((Aresta.origem == iOrigem && Aresta.destino == iDestino) || (Aresta.origem == iDestino && Aresta.destino == iOrigem))
+            iCusto = min(iCusto, Aresta.custoTransito);
+    for (const sArco& Arco : Grafo.vsArcos)
+        if (Arco.origem == iOrigem && Arco.destino == iDestino)
+            iCusto = min(iCusto, Arco.custoTransito);
+    return iCusto;
+}
+
+// Reducao do custo da ligacao u->v para iCusto: uma passada O(V^2), pois todo
+// caminho que melhora passa a ser i ~> u -> v ~> j
+void reduzirCustoLigacao(int u, int v, int iCusto, vector<vector<int>>& vviDistancias, vector<vector<int>>& vviPredecessores) {
+    int iTamanho = (int)vviDistancias.size();
+    const vector<int>& viDistanciasV = vviDistancias[v];
+    const vector<int>& viPredecessoresV = vviPredecessores[v];
+    for (int i = 1; i < iTamanho; ++i) {
+        if (vviDistancias[i][u] == INF)
+            continue;
+        long long lAteV = (long long)vviDistancias[i][u] + iCusto;
+        if (lAteV >= vviDistancias[i][v])
+            continue;
+        vector<int>& viDistanciasI = vviDistancias[i];
+        vector<int>& viPredecessoresI = vviPredecessores[i];
+        for (int j = 1; j < iTamanho; ++j) {
+            if (viDistanciasV[j] == INF || lAteV + viDistanciasV[j] >= viDistanciasI[j])
+                continue;
+            viDistanciasI[j] = (int)(lAteV + viDistanciasV[j]);
+            viPredecessoresI[j] = j == v ? u : viPredecessoresV[j];
+        }
+    }
+}
+
+// Refaz a linha da origem iOrigem com Dijkstra sobre a lista de adjacencia
+void recalcularOrigem(int iOrigem, const vector<vector<sVizinho>>& vvsAdjacentes,
+                      vector<vector<int>>& vviDistancias, vector<vector<int>>& vviPredecessores) {
+    vector<int>& viDistancias = vviDistancias[iOrigem];
+    vector<int>& viPredecessores = vviPredecessores[iOrigem];
+    fill(viDistancias.begin(), viDistancias.end(), INF);
+    fill(viPredecessores.begin(), viPredecessores.end(), -1);
+    viDistancias[iOrigem] = 0;
+    viPredecessores[iOrigem] = iOrigem;
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> fila;
+    fila.push({0, iOrigem});
+    while (!fila.empty()) {
+        auto [iDistancia, u] = fila.top();
+        fila.pop();
+        if (iDistancia > viDistancias[u])
+            continue;
+        for (const sVizinho& vizinho : vvsAdjacentes[u]) {
+            if (vizinho.destino == iOrigem || (long long)iDistancia + vizinho.custo >= viDistancias[vizinho.destino])
+                continue;
+            viDistancias[vizinho.destino] = iDistancia + vizinho.custo;
+            viPredecessores[vizinho.destino] = u;
+            fila.push({viDistancias[vizinho.destino], vizinho.destino});
+        }
+    }
+}
+
+// Aumento do custo da ligacao u->v (que custava iCustoAntigo): somente as
+// origens cuja arvore de caminhos minimos usa u->v podem mudar, e so elas sao
+// recalculadas
+void aumentarCustoLigacao(int u, int v, int iCustoAntigo, const vector<vector<sVizinho>>& vvsAdjacentes,
+                          vector<vector<int>>& vviDistancias, vector<vector<int>>& vviPredecessores) {
+    int iTamanho = (int)vviDistancias.size();
+    for (int i = 1; i < iTamanho; ++i) {
+        if (i == v || vviPredecessores[i][v] != u || vviDistancias[i][u] == INF)
+            continue;
+        if ((long long)vviDistancias[i][u] + iCustoAntigo != vviDistancias[i][v])
+            continue;
+        recalcularOrigem(i, vvsAdjacentes, vviDistancias, vviPredecessores);
+    }
+}
+
+// Altera o custo de transito das ligacoes entre iOrigem e iDestino (arestas em
+// qualquer sentido, arcos so de iOrigem para iDestino; ligacoes paralelas
+// recebem o mesmo custo) e atualiza as matrizes para que continuem iguais as de
+// um Floyd-Warshall completo. Devolve false se nao houver tal ligacao.
+bool bAlterarCustoTransito(
+							sGrafo& Grafo,
+							bool bArco,
+							int iOrigem,
+							int iDestino,
+							int iNovoCusto,
+							vector<vector<int>>& vviDistancias,
+							vector<vector<int>>& vviPredecessores
+) {
+    vector<pair<int, int>> vparSentidos = {{iOrigem, iDestino}};
+    if (!bArco)
+        vparSentidos.push_back({iDestino, iOrigem});
+    vector<int> viCustosAntigos;
+    for (auto [u, v] : vparSentidos)
+        viCustosAntigos.push_back(iCustoLigacaoDireta(Grafo, u, v));
+
+    bool bEncontrou = false;
+    if (bArco) {
+        for (sArco& Arco : Grafo.vsArcos)
+            if (Arco.origem == iOrigem && Arco.destino == iDestino) {
+                Arco.custoTransito = iNovoCusto;
+                bEncontrou = true;
+            }
+    } else {
+        for (sAresta& Aresta : Grafo.vsArestas)
+            if ((Aresta.origem == iOrigem && Aresta.destino == iDestino) || (Aresta.origem == iDestino && Aresta.destino == iOrigem)) {
+                Aresta.custoTransito = iNovoCusto;
+                bEncontrou = true;
+            }
+    }
+    if (!bEncontrou)
+        return false;
+
+    vector<vector<sVizinho>> vvsAdjacentes;
+    for (size_t s = 0; s < vparSentidos.size(); ++s) {
+        auto [u, v] = vparSentidos[s];
+        int iCustoNovo = iCustoLigacaoDireta(Grafo, u, v);
+        if (iCustoNovo < viCustosAntigos[s]) {
+            reduzirCustoLigacao(u, v, iCustoNovo, vviDistancias, vviPredecessores);
+        } else if (iCustoNovo > viCustosAntigos[s]) {
+            if (vvsAdjacentes.empty()) {
+                vvsAdjacentes.resize(vviDistancias.size());
+                for (const sAresta& Aresta : Grafo.vsArestas) {
+                    vvsAdjacentes[Aresta.origem].push_back({Aresta.destino, Aresta.custoTransito});
+                    vvsAdjacentes[Aresta.destino].push_back({Aresta.origem, Aresta.custoTransito});
+                }
+                for (const sArco& Arco : Grafo.vsArcos)
+                    vvsAdjacentes[Arco.origem].push_back({Arco.destino, Arco.custoTransito});
+            }
+            aumentarCustoLigacao(u, v, viCustosAntigos[s], vvsAdjacentes, vviDistancias, vviPredecessores);
+        }
+    }
+    return true;
+}
+
+// Uma linha do arquivo de alteracoes de custo: "E origem destino custo" para
+// arestas ou "A origem destino custo" para arcos
+struct sAlteracaoCusto {
+    bool bArco;
+    int iOrigem;
+    int iDestino;
+    int iNovoCusto;
+};
+
+bool bLerAlteracoesCusto(const string& sCaminhoArquivo, vector<sAlteracaoCusto>& vsAlteracoes) {
+    ifstream arquivo(sCaminhoArquivo);
+    if (!arquivo.is_open()) {
+        cerr << "Nao foi possivel abrir o arquivo de alteracoes de custo: " << sCaminhoArquivo << endl;
+        return false;
+    }
+    string sLinha;
+    int iLinha = 0;
+    while (getline(arquivo, sLinha)) {
+        iLinha++;
+        istringstream linha(sLinha);
+        string sTipo;
+        if (!(linha >> sTipo) || sTipo[0] == '#')
+            continue;
+        sAlteracaoCusto alteracao;
+        alteracao.bArco = sTipo == "A";
+        if ((sTipo != "A" && sTipo != "E") || !(linha >> alteracao.iOrigem >> alteracao.iDestino >> alteracao.iNovoCusto) ||
+            alteracao.iNovoCusto < 0) {
+            cerr << "Linha " << iLinha << " invalida em " << sCaminhoArquivo << endl;
+            return false;
+        }
+        vsAlteracoes.push_back(alteracao);
+    }
+    return true;
+}
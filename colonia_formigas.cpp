@@ -1,4 +1,8 @@
 #include "grafo.hpp"
+#include "solucao.hpp"
+#include "metricas.hpp"
+#include "roleta.hpp"
+#include "rastreamento.hpp"
 #include <vector>
 #include <cmath>
 #include <limits>
@@ -7,88 +11,273 @@
 #include <fstream>
 #include <chrono>
 #include <iostream>
-#include <map>
+#include <memory>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 using namespace std;
 
-double INFLUENCIA_FEROMONIO = 1.0; // Influência do feromônio
-double INFLUENCIA_HEURISTICA = 3.0; // Influência da heurística (1/distancia)
-const double TAXA_EVAPORACAO_FEROMONIO = 0.2; // Taxa de evaporacao
+// Tabela imutavel de servicos da instancia: o servico de indice i tem id i + 1.
+// E montada uma unica vez por execucao do ACO e compartilhada por todas as formigas.
+struct sTabelaServicos {
+    vector<sServico> vsServicos;
 
-int NUM_FORMIGAS = 20;
-int NUM_ITERACOES = 300;
+    int iTamanho() const { return (int)vsServicos.size(); }
+    const sServico& operator[](int iIndice) const { return vsServicos[iIndice]; }
+};
 
+// Alocador por arena (bump allocator). Cada thread possui a sua; tudo que e
+// alocado durante uma iteracao do ACO e descartado de uma vez em reiniciar().
+// Blocos extras so sao criados nas primeiras iteracoes: ao reiniciar, eles sao
+// fundidos em um bloco unico, e a partir dai nao ha mais alocacao no heap.
+struct sArena {
+    vector<unique_ptr<unsigned char[]>> vBlocos;
+    vector<size_t> viTamanhoBlocos;
+    size_t iBlocoAtual = 0;
+    size_t iTopo = 0;
 
-// Representa um servico (no, aresta ou arco requerido)
-struct sServico {
-    int id;
-    int iVertice1, iVertice2; // extremidades
-    int demanda;
-    int custo;
-    bool atendido;
-};
+    void* alocarBytes(size_t iBytes, size_t iAlinhamento) {
+        while (true) {
+            if (iBlocoAtual < vBlocos.size()) {
+                size_t iInicio = (iTopo + iAlinhamento - 1) & ~(iAlinhamento - 1);
+                if (iInicio + iBytes <= viTamanhoBlocos[iBlocoAtual]) {
+                    iTopo = iInicio + iBytes;
+                    return vBlocos[iBlocoAtual].get() + iInicio;
+                }
+                if (iBlocoAtual + 1 < vBlocos.size()) {
+                    iBlocoAtual++;
+                    iTopo = 0;
+                    continue;
+                }
+            }
+            size_t iTamanhoNovo = max<size_t>(iBytes + iAlinhamento, vBlocos.empty() ? 1 << 16 : 2 * viTamanhoBlocos.back());
+            vBlocos.emplace_back(new unsigned char[iTamanhoNovo]);
+            viTamanhoBlocos.push_back(iTamanhoNovo);
+            iBlocoAtual = vBlocos.size() - 1;
+            iTopo = 0;
+        }
+    }
 
-// Representa uma rota construída por uma formiga
-struct sRota {
-    vector<sServico> vsServicos;
-    int demandaTotal = 0;
-    int custoTotal = 0;
+    template <typename T>
+    T* alocar(size_t iQuantidade) {
+        return static_cast<T*>(alocarBytes(sizeof(T) * iQuantidade, alignof(T)));
+    }
+
+    // Marca a posicao atual para que tudo alocado depois possa ser descartado
+    pair<size_t, size_t> marcar() const { return {iBlocoAtual, iTopo}; }
+    void liberarAte(pair<size_t, size_t> marca) {
+        iBlocoAtual = marca.first;
+        iTopo = marca.second;
+    }
+
+    void reiniciar() {
+        if (vBlocos.size() > 1) {
+            size_t iTotal = 0;
+            for (size_t iTamanhoBloco : viTamanhoBlocos) iTotal += iTamanhoBloco;
+            vBlocos.clear();
+            viTamanhoBlocos.clear();
+            vBlocos.emplace_back(new unsigned char[iTotal]);
+            viTamanhoBlocos.push_back(iTotal);
+        }
+        iBlocoAtual = 0;
+        iTopo = 0;
+    }
 };
 
-// Representa a solucao de uma formiga (um conjunto de rotas)
-struct sSolucao {
-    vector<sRota> rotas;
+// Solucao compacta usada dentro do laco do ACO: indices de servico (int32) em
+// sequencia e o deslocamento de inicio de cada rota. A rota r ocupa
+// piServicos[piInicioRotas[r] .. piInicioRotas[r + 1]).
+struct sSolucaoPlana {
+    int32_t* piServicos = nullptr;
+    int32_t* piInicioRotas = nullptr;
+    int32_t iNumRotas = 0;
+    int32_t iNumServicos = 0;
     int iCustoTotal = 0;
 };
 
-// Funcao heurística (quanto menor a distância, melhor)
-double heuristica(int iDistancia) {
-    return iDistancia > 0 ? 1.0 / iDistancia : 0.0001;
-}
+// Copia persistente (fora da arena) da melhor solucao plana encontrada.
+// A capacidade dos vetores e reservada uma vez, entao copiar() nao aloca.
+struct sSolucaoPlanaIncumbente {
+    vector<int32_t> viServicos;
+    vector<int32_t> viInicioRotas;
+    int iCustoTotal = INF;
 
-// Escolhe o proximo servico baseado em probabilidade
-int escolherProximo(
-						const sServico& servicoAtual, 
-						const vector<sServico>& vsCandidatos, 
-						const map<pair<int, int>, double>& mFeromonio, 
-						const vector<vector<int>>& vviDistancias, 
-						int iDeposito
-) {
-    vector<double> vdProbabilidade;
-    double dSoma = 0;
+    void reservar(int iNumServicos) {
+        viServicos.reserve(iNumServicos);
+        viInicioRotas.reserve(iNumServicos + 1);
+    }
+
+    void copiar(const sSolucaoPlana& solucao) {
+        viServicos.assign(solucao.piServicos, solucao.piServicos + solucao.iNumServicos);
+        viInicioRotas.assign(solucao.piInicioRotas, solucao.piInicioRotas + solucao.iNumRotas + 1);
+        iCustoTotal = solucao.iCustoTotal;
+    }
+
+    int iNumRotas() const { return viInicioRotas.empty() ? 0 : (int)viInicioRotas.size() - 1; }
+};
 
-    for (const sServico& servicoCandidato : vsCandidatos) {
-        auto chave = make_pair(servicoAtual.iVertice1, servicoCandidato.iVertice1);
-		double f = pow(mFeromonio.at(chave), INFLUENCIA_FEROMONIO);
+const double FEROMONIO_INICIAL = 1.0; // valor de todas as entradas no inicio do ACO
 
-		// Novo cálculo heurístico baseado no custo total de inclusao
-		int iCustoInclusao = vviDistancias[servicoAtual.iVertice1][servicoCandidato.iVertice1] + 
-							 servicoCandidato.custo + 
-							 vviDistancias[servicoCandidato.iVertice2][iDeposito];
+// Feromonio por par (servico anterior, proximo servico), guardado so para os k
+// candidatos mais proximos de cada servico em formato CSR: a linha i ocupa
+// [viInicioLinha[i], viInicioLinha[i + 1]) de viCandidatos e vdValores, com os
+// candidatos do mais proximo para o mais distante. A ultima linha e a do
+// deposito (inicio de rota), que tem todos os servicos na ordem da tabela, ja
+// que o primeiro servico de uma rota costuma ficar longe dele. Os pares fora
+// das listas valem dValorFora, que evapora junto e nao recebe deposito.
+// Memoria O(S.k) em vez de (V+1)^2.
+struct sFeromonioCandidatos {
+    int iNumServicos = 0;
+    vector<int32_t> viInicioLinha;
+    vector<int32_t> viCandidatos;
+    vector<double> vdValores;
+    double dValorFora = 0.0;
 
-		double h = pow(1.0 / (iCustoInclusao + 1), INFLUENCIA_HEURISTICA);
+    // iNumVizinhos <= 0 mantem todos os servicos alcancaveis como candidatos
+    void inicializar(
+                    const sTabelaServicos& tabela,
+                    const vector<vector<int>>& vviDistancias,
+                    int iNumVizinhos,
+                    double dValorInicial
+    ) {
+        iNumServicos = tabela.iTamanho();
+        viInicioLinha.assign(1, 0);
+        viCandidatos.clear();
+        vector<pair<int, int32_t>> vparProximos;
+        for (int i = 0; i < iNumServicos; ++i) {
+            vparProximos.clear();
+            const vector<int>& viDistanciasFim = vviDistancias[tabela[i].iVertice2];
+            for (int j = 0; j < iNumServicos; ++j)
+                if (j != i && viDistanciasFim[tabela[j].iVertice1] != INF)
+                    vparProximos.push_back({viDistanciasFim[tabela[j].iVertice1], j});
+            size_t iQuantidade = iNumVizinhos > 0 ? min(vparProximos.size(), (size_t)iNumVizinhos) : vparProximos.size();
+            partial_sort(vparProximos.begin(), vparProximos.begin() + iQuantidade, vparProximos.end());
+            for (size_t c = 0; c < iQuantidade; ++c)
+                viCandidatos.push_back(vparProximos[c].second);
+            viInicioLinha.push_back((int32_t)viCandidatos.size());
+        }
+        for (int j = 0; j < iNumServicos; ++j)
+            viCandidatos.push_back(j);
+        viInicioLinha.push_back((int32_t)viCandidatos.size());
+        reiniciar(dValorInicial);
+    }
 
-		vdProbabilidade.push_back(f * h);
-        dSoma += vdProbabilidade.back();
+    void reiniciar(double dValorInicial) {
+        vdValores.assign(viCandidatos.size(), dValorInicial);
+        dValorFora = dValorInicial;
     }
 
-    // Roleta para gerar valor aleatorio, conforme o conceito do ACO
-    // Cria um gerador de números aleatorios baseado no sistema, usado para inicializar o gerador aleatorio com uma semente.
-    random_device geradorSeed;
-    // Inicializa o gerador com a semente gerada pelo random_device
-    mt19937 gen(geradorSeed());
-    // Cria uma distribuicao uniforme real no intervalo (0.0, soma), ou seja, todos valores no intervalo tem mesma chance
-    uniform_real_distribution<> dis(0.0, dSoma);
-    double dNumeroAleatorio = dis(gen);
-    
-    for (int i = 0; i < (int)vdProbabilidade.size(); ++i) {
-        dNumeroAleatorio -= vdProbabilidade[i];
-        if (dNumeroAleatorio <= 0) return i;
+    int iLinhaDeposito() const { return iNumServicos; }
+
+    // Posicao do par (linha, servico) em vdValores, ou -1 fora dos candidatos
+    int64_t iChave(int iLinha, int iServico) const {
+        if (iLinha == iLinhaDeposito())
+            return viInicioLinha[iLinha] + iServico;
+        for (int32_t c = viInicioLinha[iLinha]; c < viInicioLinha[iLinha + 1]; ++c)
+            if (viCandidatos[c] == iServico)
+                return c;
+        return -1;
     }
-    
-    return (int)vdProbabilidade.size() - 1;
+
+    void evaporar(double dTaxa) {
+        for (double& dValor : vdValores)
+            dValor *= (1.0 - dTaxa);
+        dValorFora *= (1.0 - dTaxa);
+    }
+};
+
+// Acumulador esparso (enderecamento aberto) das contribuicoes de feromonio de
+// uma thread durante a iteracao. Ocupa memoria proporcional aos pares
+// distintos tocados e e aplicado no feromonio uma unica vez por iteracao.
+struct sBufferDelta {
+    vector<int64_t> viChaves;
+    vector<double> vdValores;
+    vector<int32_t> viOcupadas;
+
+    size_t iPosicaoInicial(int64_t iChave) const {
+        uint64_t h = (uint64_t)iChave * 0x9E3779B97F4A7C15ull;
+        return (size_t)(h >> 20) & (viChaves.size() - 1);
+    }
+
+    void redimensionar(size_t iNovaCapacidade) {
+        vector<int64_t> viChavesAntigas;
+        vector<double> vdValoresAntigos;
+        viChavesAntigas.swap(viChaves);
+        vdValoresAntigos.swap(vdValores);
+        viChaves.assign(iNovaCapacidade, -1);
+        vdValores.assign(iNovaCapacidade, 0.0);
+        viOcupadas.clear();
+        for (size_t i = 0; i < viChavesAntigas.size(); ++i)
+            if (viChavesAntigas[i] >= 0)
+                acumular(viChavesAntigas[i], vdValoresAntigos[i]);
+    }
+
+    void acumular(int64_t iChave, double dValor) {
+        if (2 * (viOcupadas.size() + 1) > viChaves.size())
+            redimensionar(viChaves.empty() ? 1024 : 2 * viChaves.size());
+        size_t iPosicao = iPosicaoInicial(iChave);
+        while (viChaves[iPosicao] != iChave) {
+            if (viChaves[iPosicao] < 0) {
+                viChaves[iPosicao] = iChave;
+                viOcupadas.push_back((int32_t)iPosicao);
+                break;
+            }
+            iPosicao = (iPosicao + 1) & (viChaves.size() - 1);
+        }
+        vdValores[iPosicao] += dValor;
+    }
+
+    // Soma o conteudo no feromonio e deixa o buffer vazio (sem liberar memoria)
+    void aplicar(sFeromonioCandidatos& feromonio) {
+        METRICA_CONTAR(CONT_ENTRADAS_FEROMONIO, viOcupadas.size());
+        for (int32_t iPosicao : viOcupadas) {
+            feromonio.vdValores[viChaves[iPosicao]] += vdValores[iPosicao];
+            viChaves[iPosicao] = -1;
+            vdValores[iPosicao] = 0.0;
+        }
+        viOcupadas.clear();
+    }
+};
+
+// Guarda as k melhores solucoes vistas por uma thread na iteracao corrente
+struct sColetorMelhores {
+    vector<sSolucaoPlanaIncumbente> vsSolucoes;
+    int iQuantidade = 0;
+
+    void configurar(int iK, int iNumServicos) {
+        vsSolucoes.resize(max(iK, 0));
+        for (auto& solucao : vsSolucoes)
+            solucao.reservar(iNumServicos);
+        iQuantidade = 0;
+    }
+
+    void considerar(const sSolucaoPlana& solucao) {
+        if (vsSolucoes.empty())
+            return;
+        if (iQuantidade < (int)vsSolucoes.size()) {
+            vsSolucoes[iQuantidade++].copiar(solucao);
+            return;
+        }
+        int iPior = 0;
+        for (int i = 1; i < iQuantidade; ++i)
+            if (vsSolucoes[i].iCustoTotal > vsSolucoes[iPior].iCustoTotal)
+                iPior = i;
+        if (solucao.iCustoTotal < vsSolucoes[iPior].iCustoTotal)
+            vsSolucoes[iPior].copiar(solucao);
+    }
+};
+
+// Funcao heurística (quanto menor a distância, melhor)
+double heuristica(int iDistancia) {
+    return iDistancia > 0 ? 1.0 / iDistancia : 0.0001;
 }
 
+
+
 // Inicializa a lista de servicos a partir do grafo
 vector<sServico> extrairServicos(const sGrafo& grafo) {
     vector<sServico> vsLista;
@@ -110,7 +299,7 @@ vector<sServico> extrairServicos(const sGrafo& grafo) {
     // arestas (demanda > 0 como critério)
     for (const auto& aresta : grafo.vsArestas)
         if (aresta.demanda > 0)
-            vsLista.push_back({id++, aresta.origem, aresta.destino, aresta.demanda, aresta.custoAtendimento, false});
+            vsLista.push_back({id++, aresta.origem, aresta.destino, aresta.demanda, aresta.custoAtendimento, false, true});
 
     // arcos
     for (const auto& arco : grafo.vsArcos)
@@ -120,6 +309,38 @@ vector<sServico> extrairServicos(const sGrafo& grafo) {
     return vsLista;
 }
 
+sTabelaServicos sCriarTabelaServicos(const sGrafo& grafo) {
+    sTabelaServicos tabela;
+    tabela.vsServicos = extrairServicos(grafo);
+    return tabela;
+}
+
+// Converte a solucao plana para a representacao com rotas usada pela busca local
+// e pela gravacao em arquivo
+sSolucao sConverterSolucaoPlana(
+									const sSolucaoPlanaIncumbente& solucaoPlana,
+									const sTabelaServicos& tabela,
+									const vector<vector<int>>& vviDistancias,
+									int iDeposito
+) {
+    sSolucao solucao;
+    solucao.rotas.resize(solucaoPlana.iNumRotas());
+    for (int r = 0; r < solucaoPlana.iNumRotas(); ++r) {
+        sRota& rota = solucao.rotas[r];
+        int iAtual = iDeposito;
+        for (int p = solucaoPlana.viInicioRotas[r]; p < solucaoPlana.viInicioRotas[r + 1]; ++p) {
+            const sServico& servico = tabela[solucaoPlana.viServicos[p]];
+            rota.vsServicos.push_back(servico);
+            rota.demandaTotal += servico.demanda;
+            rota.custoTotal += vviDistancias[iAtual][servico.iVertice1] + servico.custo;
+            iAtual = servico.iVertice2;
+        }
+        rota.custoTotal += vviDistancias[iAtual][iDeposito];
+        solucao.iCustoTotal += rota.custoTotal;
+    }
+    return solucao;
+}
+
 // Calcula o custo de uma rota (sequência de servicos) a partir do deposito:
 // custoRota corrigido: soma arcos so uma vez no fim
 double custoRota(
@@ -127,6 +348,7 @@ double custoRota(
 					const vector<vector<int>>& vviDistancias,
 					int iDeposito
 ) {
+    METRICA_CONTAR(CONT_CHAMADAS_CUSTO_ROTA, 1);
     double dCusto = 0.0;
     int iAtual = iDeposito;
 
@@ -161,6 +383,7 @@ bool twoOptTrecho(
 
     for (int i = 0; i < iQuantidadeServicos - 1; ++i) {
         for (int j = i + 1; j < iQuantidadeServicos; ++j) {
+            METRICA_CONTAR(CONT_TWO_OPT_TENTADOS, 1);
             reverse(vsSequencia.begin()+i, vsSequencia.begin()+j+1);
             double novoCusto = custoRota(vsSequencia, vviDistancias, iDeposito);
             double dGanho = custoOriginal - novoCusto;
@@ -182,6 +405,7 @@ bool twoOptTrecho(
 	// (maior que 0.000001) para evitar aceitar diferenças 
 	// causadas por imprecisão numérica 
     if (dMelhorGanho > 1e-6) {
+        METRICA_CONTAR(CONT_TWO_OPT_ACEITOS, 1);
         reverse(
 					vsSequencia.begin() + iMelhorI, 
 					vsSequencia.begin() + iMelhorJ + 1
@@ -208,6 +432,7 @@ bool swapServico(
 
     for (int i = 0; i < iQuantidadeServicos - 1; ++i) {
         for (int j = i + 1; j < iQuantidadeServicos; ++j) {
+            METRICA_CONTAR(CONT_SWAP_TENTADOS, 1);
             swap(vsSequencia[i], vsSequencia[j]);
             double novoCusto = custoRota(vsSequencia, vviDistancias, iDeposito);
             double dGanho = custoOriginal - novoCusto;
@@ -226,6 +451,7 @@ bool swapServico(
 	// (maior que 0.000001) para evitar aceitar diferenças 
 	// causadas por imprecisão numérica 
     if (dMelhorGanho > 1e-6) {
+        METRICA_CONTAR(CONT_SWAP_ACEITOS, 1);
         swap(vsSequencia[iMelhorI], vsSequencia[iMelhorJ]);
         return true;
     }
@@ -233,20 +459,498 @@ bool swapServico(
     return false;
 }
 
+// Movimentos entre duas rotas com avaliacao O(1) do ganho (somente os trechos de
+// ligacao mudam; o custo interno dos trechos movidos se mantem) e verificacao de
+// capacidade pelas somas de prefixo da demanda das rotas.
+enum eTipoMovimento {
+    MOV_NENHUM,
+    MOV_RELOCATE,        // move um servico de A para B
+    MOV_EXCHANGE,        // troca um servico de A por um servico de B
+    MOV_OR_OPT,          // move um trecho de 1 a 3 servicos de A para B
+    MOV_TWO_OPT_ESTRELA, // troca as caudas de A e B
+    MOV_CROSS            // troca um trecho de A por um trecho de B (1 a 3 servicos cada)
+};
+
+const int TAMANHO_MAXIMO_TRECHO = 3;
+
+struct sMovimento {
+    eTipoMovimento tipo = MOV_NENHUM;
+    int iRotaA = -1, iRotaB = -1;
+    int iPosicaoA = 0, iPosicaoB = 0; // inicio dos trechos ou, no 2-opt*, ultima posicao mantida
+    int iTamanhoA = 0, iTamanhoB = 0;
+    int iGanho = 0;
+};
+
+// Visao de uma rota para a avaliacao dos movimentos: posicoes fora da rota
+// (-1 e n) correspondem ao deposito
+struct sVisaoRota {
+    const vector<sServico>& vsServicos;
+    vector<int> viDemandaAcumulada; // viDemandaAcumulada[k] = demanda dos k primeiros servicos
+    int iDeposito;
+
+    sVisaoRota(const sRota& rota, int iDepositoRota) : vsServicos(rota.vsServicos), iDeposito(iDepositoRota) {
+        viDemandaAcumulada.resize(vsServicos.size() + 1, 0);
+        for (size_t k = 0; k < vsServicos.size(); ++k)
+            viDemandaAcumulada[k + 1] = viDemandaAcumulada[k] + vsServicos[k].demanda;
+    }
+
+    int iTamanho() const { return (int)vsServicos.size(); }
+    int iFim(int k) const { return k < 0 ? iDeposito : vsServicos[k].iVertice2; }
+    int iInicio(int k) const { return k >= iTamanho() ? iDeposito : vsServicos[k].iVertice1; }
+    int iDemandaTrecho(int iPosicao, int iTamanhoTrecho) const {
+        return viDemandaAcumulada[iPosicao + iTamanhoTrecho] - viDemandaAcumulada[iPosicao];
+    }
+    int iDemandaTotal() const { return viDemandaAcumulada.back(); }
+};
+
+// Or-opt: melhor trecho de 1 a 3 servicos de A inserido em alguma posicao de B
+void avaliarOrOpt(
+					const sVisaoRota& A, const sVisaoRota& B, int iRotaA, int iRotaB,
+					const vector<vector<int>>& vviDistancias, int iCapacidadeVeiculo, sMovimento& melhor
+) {
+    for (int iTamanhoTrecho = 1; iTamanhoTrecho <= TAMANHO_MAXIMO_TRECHO; ++iTamanhoTrecho) {
+        for (int i = 0; i + iTamanhoTrecho <= A.iTamanho(); ++i) {
+            int iDemandaTrecho = A.iDemandaTrecho(i, iTamanhoTrecho);
+            if (B.iDemandaTotal() + iDemandaTrecho > iCapacidadeVeiculo)
+                continue;
+            int iPrimeiro = A.iInicio(i);
+            int iUltimo = A.iFim(i + iTamanhoTrecho - 1);
+            int iGanhoRemocao = vviDistancias[A.iFim(i - 1)][iPrimeiro]
+                              + vviDistancias[iUltimo][A.iInicio(i + iTamanhoTrecho)]
+                              - vviDistancias[A.iFim(i - 1)][A.iInicio(i + iTamanhoTrecho)];
+            for (int j = 0; j <= B.iTamanho(); ++j) {
+                METRICA_CONTAR(CONT_OR_OPT_TENTADOS, 1);
+                int iCustoInsercao = vviDistancias[B.iFim(j - 1)][iPrimeiro]
+                                   + vviDistancias[iUltimo][B.iInicio(j)]
+                                   - vviDistancias[B.iFim(j - 1)][B.iInicio(j)];
+                int iGanho = iGanhoRemocao - iCustoInsercao;
+                if (iGanho > melhor.iGanho)
+                    melhor = {MOV_OR_OPT, iRotaA, iRotaB, i, j, iTamanhoTrecho, 0, iGanho};
+            }
+        }
+    }
+}
+
+// 2-opt*: A' = A[0..i] + B[j+1..] e B' = B[0..j] + A[i+1..]
+void avaliarTwoOptEstrela(
+							const sVisaoRota& A, const sVisaoRota& B, int iRotaA, int iRotaB,
+							const vector<vector<int>>& vviDistancias, int iCapacidadeVeiculo, sMovimento& melhor
+) {
+    for (int i = -1; i < A.iTamanho(); ++i) {
+        int iDemandaCabecaA = A.viDemandaAcumulada[i + 1];
+        int iDemandaCaudaA = A.iDemandaTotal() - iDemandaCabecaA;
+        for (int j = -1; j < B.iTamanho(); ++j) {
+            // cortes nas duas pontas apenas trocariam as rotas inteiras
+            if ((i == -1 && j == -1) || (i == A.iTamanho() - 1 && j == B.iTamanho() - 1))
+                continue;
+            int iDemandaCabecaB = B.viDemandaAcumulada[j + 1];
+            int iDemandaCaudaB = B.iDemandaTotal() - iDemandaCabecaB;
+            if (iDemandaCabecaA + iDemandaCaudaB > iCapacidadeVeiculo || iDemandaCabecaB + iDemandaCaudaA > iCapacidadeVeiculo)
+                continue;
+            METRICA_CONTAR(CONT_TWO_OPT_ESTRELA_TENTADOS, 1);
+            int iGanho = vviDistancias[A.iFim(i)][A.iInicio(i + 1)]
+                       + vviDistancias[B.iFim(j)][B.iInicio(j + 1)]
+                       - vviDistancias[A.iFim(i)][B.iInicio(j + 1)]
+                       - vviDistancias[B.iFim(j)][A.iInicio(i + 1)];
+            if (iGanho > melhor.iGanho)
+                melhor = {MOV_TWO_OPT_ESTRELA, iRotaA, iRotaB, i, j, 0, 0, iGanho};
+        }
+    }
+}
+
+// CROSS-exchange: troca A[i..i+la-1] com B[j..j+lb-1]
+void avaliarCross(
+					const sVisaoRota& A, const sVisaoRota& B, int iRotaA, int iRotaB,
+					const vector<vector<int>>& vviDistancias, int iCapacidadeVeiculo, sMovimento& melhor
+) {
+    for (int iTamanhoA = 1; iTamanhoA <= TAMANHO_MAXIMO_TRECHO; ++iTamanhoA) {
+        for (int i = 0; i + iTamanhoA <= A.iTamanho(); ++i) {
+            int iDemandaA = A.iDemandaTrecho(i, iTamanhoA);
+            int iAntesA = A.iFim(i - 1), iDepoisA = A.iInicio(i + iTamanhoA);
+            int iPrimeiroA = A.iInicio(i), iUltimoA = A.iFim(i + iTamanhoA - 1);
+            int iCustoAtualA = vviDistancias[iAntesA][iPrimeiroA] + vviDistancias[iUltimoA][iDepoisA];
+            for (int iTamanhoB = 1; iTamanhoB <= TAMANHO_MAXIMO_TRECHO; ++iTamanhoB) {
+                for (int j = 0; j + iTamanhoB <= B.iTamanho(); ++j) {
+                    int iDemandaB = B.iDemandaTrecho(j, iTamanhoB);
+                    if (A.iDemandaTotal() - iDemandaA + iDemandaB > iCapacidadeVeiculo ||
+                        B.iDemandaTotal() - iDemandaB + iDemandaA > iCapacidadeVeiculo)
+                        continue;
+                    METRICA_CONTAR(CONT_CROSS_TENTADOS, 1);
+                    int iAntesB = B.iFim(j - 1), iDepoisB = B.iInicio(j + iTamanhoB);
+                    int iPrimeiroB = B.iInicio(j), iUltimoB = B.iFim(j + iTamanhoB - 1);
+                    int iGanho = iCustoAtualA
+                               + vviDistancias[iAntesB][iPrimeiroB] + vviDistancias[iUltimoB][iDepoisB]
+                               - vviDistancias[iAntesA][iPrimeiroB] - vviDistancias[iUltimoB][iDepoisA]
+                               - vviDistancias[iAntesB][iPrimeiroA] - vviDistancias[iUltimoA][iDepoisB];
+                    if (iGanho > melhor.iGanho)
+                        melhor = {MOV_CROSS, iRotaA, iRotaB, i, j, iTamanhoA, iTamanhoB, iGanho};
+                }
+            }
+        }
+    }
+}
+
+// Relocate e Exchange de um servico entre a rota alterada A e a rota B. Servicos de A
+// com o bit "nao olhar" ligado ja foram avaliados contra B sem os vizinhos atuais
+// terem mudado e sao pulados como origem; servicos de B sao sempre levados para A,
+// pois A mudou desde a ultima avaliacao.
+void avaliarRelocateExchange(
+								const sVisaoRota& A, const sVisaoRota& B, int iRotaA, int iRotaB,
+								const vector<char>& vbNaoOlhar,
+								const vector<vector<int>>& vviDistancias, int iCapacidadeVeiculo, sMovimento& melhor
+) {
+    auto iGanhoRemocao = [&](const sVisaoRota& R, int k) {
+        return vviDistancias[R.iFim(k - 1)][R.iInicio(k)]
+             + vviDistancias[R.iFim(k)][R.iInicio(k + 1)]
+             - vviDistancias[R.iFim(k - 1)][R.iInicio(k + 1)];
+    };
+    auto avaliarRelocate = [&](const sVisaoRota& O, const sVisaoRota& D, int iOrigem, int iDestino, bool bUsaBits) {
+        for (int k = 0; k < O.iTamanho(); ++k) {
+            if (bUsaBits && vbNaoOlhar[O.vsServicos[k].id])
+                continue;
+            if (D.iDemandaTotal() + O.vsServicos[k].demanda > iCapacidadeVeiculo)
+                continue;
+            int iRemocao = iGanhoRemocao(O, k);
+            for (int j = 0; j <= D.iTamanho(); ++j) {
+                METRICA_CONTAR(CONT_RELOCATE_TENTADOS, 1);
+                int iGanho = iRemocao
+                           - vviDistancias[D.iFim(j - 1)][O.iInicio(k)]
+                           - vviDistancias[O.iFim(k)][D.iInicio(j)]
+                           + vviDistancias[D.iFim(j - 1)][D.iInicio(j)];
+                if (iGanho > melhor.iGanho)
+                    melhor = {MOV_RELOCATE, iOrigem, iDestino, k, j, 1, 0, iGanho};
+            }
+        }
+    };
+    avaliarRelocate(A, B, iRotaA, iRotaB, true);
+    avaliarRelocate(B, A, iRotaB, iRotaA, false);
+
+    for (int i = 0; i < A.iTamanho(); ++i) {
+        bool bNaoOlharA = vbNaoOlhar[A.vsServicos[i].id];
+        int iAntesA = A.iFim(i - 1), iDepoisA = A.iInicio(i + 1);
+        int iCustoAtualA = vviDistancias[iAntesA][A.iInicio(i)] + vviDistancias[A.iFim(i)][iDepoisA];
+        for (int j = 0; j < B.iTamanho(); ++j) {
+            if (bNaoOlharA && vbNaoOlhar[B.vsServicos[j].id])
+                continue;
+            int iDiferenca = B.vsServicos[j].demanda - A.vsServicos[i].demanda;
+            if (A.iDemandaTotal() + iDiferenca > iCapacidadeVeiculo || B.iDemandaTotal() - iDiferenca > iCapacidadeVeiculo)
+                continue;
+            METRICA_CONTAR(CONT_EXCHANGE_TENTADOS, 1);
+            int iAntesB = B.iFim(j - 1), iDepoisB = B.iInicio(j + 1);
+            int iGanho = iCustoAtualA
+                       + vviDistancias[iAntesB][B.iInicio(j)] + vviDistancias[B.iFim(j)][iDepoisB]
+                       - vviDistancias[iAntesA][B.iInicio(j)] - vviDistancias[B.iFim(j)][iDepoisA]
+                       - vviDistancias[iAntesB][A.iInicio(i)] - vviDistancias[A.iFim(i)][iDepoisB];
+            if (iGanho > melhor.iGanho)
+                melhor = {MOV_EXCHANGE, iRotaA, iRotaB, i, j, 1, 1, iGanho};
+        }
+    }
+}
+
+// Melhor movimento Or-opt (nos dois sentidos), 2-opt* ou CROSS entre as rotas a e b
+sMovimento avaliarMovimentosEntreRotas(
+										const sSolucao& solucao, int a, int b,
+										const vector<vector<int>>& vviDistancias,
+										int iDeposito, int iCapacidadeVeiculo
+) {
+    sVisaoRota A(solucao.rotas[a], iDeposito);
+    sVisaoRota B(solucao.rotas[b], iDeposito);
+    sMovimento melhor;
+    avaliarOrOpt(A, B, a, b, vviDistancias, iCapacidadeVeiculo, melhor);
+    avaliarOrOpt(B, A, b, a, vviDistancias, iCapacidadeVeiculo, melhor);
+    avaliarTwoOptEstrela(A, B, a, b, vviDistancias, iCapacidadeVeiculo, melhor);
+    avaliarCross(A, B, a, b, vviDistancias, iCapacidadeVeiculo, melhor);
+    return melhor;
+}
+
+// Recalcula demanda e custo de uma rota depois de alterada
+void atualizarRota(sRota& rota, const vector<vector<int>>& vviDistancias, int iDeposito) {
+    rota.demandaTotal = 0;
+    for (const sServico& servico : rota.vsServicos)
+        rota.demandaTotal += servico.demanda;
+    rota.custoTotal = (int)custoRota(rota.vsServicos, vviDistancias, iDeposito);
+}
+
+void aplicarMovimento(sSolucao& solucao, const sMovimento& movimento, const vector<vector<int>>& vviDistancias, int iDeposito) {
+    vector<sServico>& vsA = solucao.rotas[movimento.iRotaA].vsServicos;
+    vector<sServico>& vsB = solucao.rotas[movimento.iRotaB].vsServicos;
+    int i = movimento.iPosicaoA, j = movimento.iPosicaoB;
+
+    switch (movimento.tipo) {
+        case MOV_RELOCATE:
+        case MOV_OR_OPT: {
+            if (movimento.tipo == MOV_RELOCATE)
+                METRICA_CONTAR(CONT_RELOCATE_ACEITOS, 1);
+            else
+                METRICA_CONTAR(CONT_OR_OPT_ACEITOS, 1);
+            vsB.insert(vsB.begin() + j, vsA.begin() + i, vsA.begin() + i + movimento.iTamanhoA);
+            vsA.erase(vsA.begin() + i, vsA.begin() + i + movimento.iTamanhoA);
+            break;
+        }
+        case MOV_TWO_OPT_ESTRELA: {
+            METRICA_CONTAR(CONT_TWO_OPT_ESTRELA_ACEITOS, 1);
+            vector<sServico> vsCaudaA(vsA.begin() + i + 1, vsA.end());
+            vsA.erase(vsA.begin() + i + 1, vsA.end());
+            vsA.insert(vsA.end(), vsB.begin() + j + 1, vsB.end());
+            vsB.erase(vsB.begin() + j + 1, vsB.end());
+            vsB.insert(vsB.end(), vsCaudaA.begin(), vsCaudaA.end());
+            break;
+        }
+        case MOV_EXCHANGE:
+        case MOV_CROSS: {
+            if (movimento.tipo == MOV_EXCHANGE)
+                METRICA_CONTAR(CONT_EXCHANGE_ACEITOS, 1);
+            else
+                METRICA_CONTAR(CONT_CROSS_ACEITOS, 1);
+            vector<sServico> vsTrechoA(vsA.begin() + i, vsA.begin() + i + movimento.iTamanhoA);
+            vector<sServico> vsTrechoB(vsB.begin() + j, vsB.begin() + j + movimento.iTamanhoB);
+            vsA.erase(vsA.begin() + i, vsA.begin() + i + movimento.iTamanhoA);
+            vsA.insert(vsA.begin() + i, vsTrechoB.begin(), vsTrechoB.end());
+            vsB.erase(vsB.begin() + j, vsB.begin() + j + movimento.iTamanhoB);
+            vsB.insert(vsB.begin() + j, vsTrechoA.begin(), vsTrechoA.end());
+            break;
+        }
+        case MOV_NENHUM:
+            return;
+    }
+    atualizarRota(solucao.rotas[movimento.iRotaA], vviDistancias, iDeposito);
+    atualizarRota(solucao.rotas[movimento.iRotaB], vviDistancias, iDeposito);
+}
+
+// Conjunto fixo de threads que executa tarefas em rodadas: as threads sao
+// criadas uma vez (por execucao do ACO ou da busca local) e, a cada rodada,
+// acordadas por uma variavel de condicao; a thread que chama tambem trabalha.
+// Uma rodada nao aloca memoria. Nao e reentrante: tarefas de uma rodada nao
+// podem abrir outra no mesmo conjunto.
+struct sConjuntoThreads {
+    mutex mRodada;
+    condition_variable cvInicio, cvFim;
+    vector<thread> vThreads;
+    uint64_t iRodada = 0;
+    bool bEncerrar = false;
+    int iPendentes = 0;        // threads auxiliares que ainda nao terminaram a rodada
+    int iParticipantes = 0;    // threads auxiliares chamadas para a rodada
+    int iNumTarefas = 0;
+    atomic<int> iProxima{0};
+    int iInstancia = -1;       // instancia rastreada de quem abriu a rodada
+    void (*pExecutarTarefa)(void*, int) = nullptr;
+    void* pTarefa = nullptr;
+
+    // iNumThreads inclui a thread que chama executar
+    explicit sConjuntoThreads(int iNumThreads) {
+        for (int t = 1; t < iNumThreads; ++t)
+            vThreads.emplace_back([this, t]() { trabalhar(t); });
+    }
+    ~sConjuntoThreads() {
+        {
+            lock_guard<mutex> trava(mRodada);
+            bEncerrar = true;
+        }
+        cvInicio.notify_all();
+        for (auto& th : vThreads)
+            th.join();
+    }
+    int iNumThreads() const { return (int)vThreads.size() + 1; }
+
+    void consumirTarefas() {
+        int i;
+        while ((i = iProxima.fetch_add(1)) < iNumTarefas)
+            pExecutarTarefa(pTarefa, i);
+    }
+
+    void trabalhar(int iIndice) {
+        uint64_t iVista = 0;
+        while (true) {
+            {
+                unique_lock<mutex> trava(mRodada);
+                cvInicio.wait(trava, [&]() { return bEncerrar || iRodada != iVista; });
+                if (bEncerrar)
+                    return;
+                iVista = iRodada;
+                if (iIndice > iParticipantes)
+                    continue;
+            }
+            definirInstanciaRastreamento(iInstancia);
+            consumirTarefas();
+            {
+                lock_guard<mutex> trava(mRodada);
+                iPendentes--;
+            }
+            cvFim.notify_one();
+        }
+    }
+
+    // Executa tarefa(i) para i em [0, iNumTarefasRodada) em ate iNumThreadsRodada threads
+    template <typename F>
+    void executar(int iNumTarefasRodada, int iNumThreadsRodada, F& tarefa) {
+        int iAuxiliares = max(0, min({iNumThreadsRodada, iNumTarefasRodada, iNumThreads()}) - 1);
+        {
+            lock_guard<mutex> trava(mRodada);
+            iNumTarefas = iNumTarefasRodada;
+            iProxima.store(0);
+            iInstancia = iInstanciaRastreamento();
+            pTarefa = &tarefa;
+            pExecutarTarefa = [](void* p, int i) { (*static_cast<F*>(p))(i); };
+            iParticipantes = iAuxiliares;
+            iPendentes = iAuxiliares;
+            if (iAuxiliares > 0)
+                iRodada++;
+        }
+        if (iAuxiliares > 0)
+            cvInicio.notify_all();
+        consumirTarefas();
+        unique_lock<mutex> trava(mRodada);
+        cvFim.wait(trava, [&]() { return iPendentes == 0; });
+    }
+};
+
+// Opcoes da busca local
+struct sOpcoesBuscaLocal {
+    // Instante limite: ao ser atingido, a busca para com a melhor solucao ate ali
+    chrono::steady_clock::time_point tPrazo = chrono::steady_clock::time_point::max();
+    const sTokenCancelamento* pCancelamento = nullptr; // opcional
+    // Rotas que iniciam a fila (e recebem a busca intra-rota); nullptr = todas.
+    // As demais so entram na fila se um movimento as alterar.
+    const vector<int>* pRotasIniciais = nullptr;
+    // Com mais de uma thread, a busca intra-rota roda em paralelo por rota e a
+    // busca entre rotas passa a ser feita em rodadas (buscaEntreRotasParalela)
+    int iNumThreads = 1;
+    // Threads ja criadas para a busca (opcional; sem elas, a busca cria as suas)
+    sConjuntoThreads* pConjuntoThreads = nullptr;
+
+    bool bInterromper() const {
+        if (pCancelamento && pCancelamento->bCancelado())
+            return true;
+        return tPrazo != chrono::steady_clock::time_point::max() && chrono::steady_clock::now() >= tPrazo;
+    }
+};
+
+// Executa tarefa(i) para i em [0, iNumTarefas) em ate iNumThreads threads do
+// conjunto (a atual inclusive); sem conjunto, na thread atual. As threads
+// herdam a instancia rastreada.
+template <typename F>
+void executarEmParalelo(sConjuntoThreads* pConjunto, int iNumTarefas, int iNumThreads, F&& tarefa) {
+    if (pConjunto && iNumThreads > 1 && iNumTarefas > 1) {
+        pConjunto->executar(iNumTarefas, iNumThreads, tarefa);
+        return;
+    }
+    for (int i = 0; i < iNumTarefas; ++i)
+        tarefa(i);
+}
+
+// Busca entre rotas em rodadas: a cada rodada, o melhor movimento de cada par
+// de rotas em que alguma delas mudou e reavaliado em paralelo (os demais pares
+// guardam o movimento da rodada anterior). Os movimentos de melhoria sao
+// ordenados por ganho (empates pelo par) e aplicados gulosamente sem repetir
+// rota, de modo que nenhum invalida outro. O resultado depende apenas da
+// solucao de entrada, nao do numero de threads nem do escalonamento.
+// Os bits "nao olhar" nao sao usados, pois dependem da ordem das avaliacoes.
+void buscaEntreRotasParalela(
+								sSolucao& solucao,
+								const vector<vector<int>>& vviDistancias,
+								int iDeposito,
+								int iCapacidadeVeiculo,
+								const vector<int>& viRotasIniciais,
+								const sOpcoesBuscaLocal& opcoes,
+								sConjuntoThreads* pConjunto
+) {
+    int iNumRotas = (int)solucao.rotas.size();
+    int iMaiorId = 0;
+    for (const auto& rota : solucao.rotas)
+        for (const auto& servico : rota.vsServicos)
+            iMaiorId = max(iMaiorId, servico.id);
+    const vector<char> vbNaoOlhar(iMaiorId + 1, 0);
+
+    // Melhor movimento conhecido de cada par (a < b), em vmMovimentos[a * n + b]
+    vector<sMovimento> vmMovimentos((size_t)iNumRotas * iNumRotas);
+    vector<char> vbAlterada(iNumRotas, 0);
+    for (int r : viRotasIniciais)
+        vbAlterada[r] = 1;
+    vector<pair<int, int>> vparAvaliar;
+    vector<char> vbUsada(iNumRotas);
+
+    while (!opcoes.bInterromper()) {
+        vparAvaliar.clear();
+        for (int a = 0; a < iNumRotas; ++a)
+            for (int b = a + 1; b < iNumRotas; ++b)
+                if (vbAlterada[a] || vbAlterada[b])
+                    vparAvaliar.push_back({a, b});
+        executarEmParalelo(pConjunto, (int)vparAvaliar.size(), opcoes.iNumThreads, [&](int iPar) {
+            int a = vparAvaliar[iPar].first, b = vparAvaliar[iPar].second;
+            sMovimento movimento;
+            // Cada par pode custar O(n^2) (CROSS): o prazo e conferido par a par
+            if (!solucao.rotas[a].vsServicos.empty() && !solucao.rotas[b].vsServicos.empty() && !opcoes.bInterromper()) {
+                {
+                    sVisaoRota A(solucao.rotas[a], iDeposito);
+                    sVisaoRota B(solucao.rotas[b], iDeposito);
+                    avaliarRelocateExchange(A, B, a, b, vbNaoOlhar, vviDistancias, iCapacidadeVeiculo, movimento);
+                }
+                sMovimento outros = avaliarMovimentosEntreRotas(solucao, a, b, vviDistancias, iDeposito, iCapacidadeVeiculo);
+                if (outros.iGanho > movimento.iGanho)
+                    movimento = outros;
+            }
+            vmMovimentos[(size_t)a * iNumRotas + b] = movimento;
+        });
+
+        // Selecao gulosa sem conflitos, em ordem deterministica
+        vector<const sMovimento*> vpMelhoria;
+        for (int a = 0; a < iNumRotas; ++a)
+            for (int b = a + 1; b < iNumRotas; ++b)
+                if (vmMovimentos[(size_t)a * iNumRotas + b].iGanho > 0)
+                    vpMelhoria.push_back(&vmMovimentos[(size_t)a * iNumRotas + b]);
+        if (vpMelhoria.empty())
+            break;
+        sort(vpMelhoria.begin(), vpMelhoria.end(), [&](const sMovimento* x, const sMovimento* y) {
+            if (x->iGanho != y->iGanho) return x->iGanho > y->iGanho;
+            return x < y; // posicao na matriz = ordem do par (a, b)
+        });
+        fill(vbUsada.begin(), vbUsada.end(), 0);
+        fill(vbAlterada.begin(), vbAlterada.end(), 0);
+        for (const sMovimento* pMovimento : vpMelhoria) {
+            if (vbUsada[pMovimento->iRotaA] || vbUsada[pMovimento->iRotaB])
+                continue;
+            vbUsada[pMovimento->iRotaA] = vbUsada[pMovimento->iRotaB] = 1;
+            vbAlterada[pMovimento->iRotaA] = vbAlterada[pMovimento->iRotaB] = 1;
+            aplicarMovimento(solucao, *pMovimento, vviDistancias, iDeposito);
+        }
+    }
+}
+
 // 3) Loop principal de busca local: aplica until no move possível
 void buscaLocal(
 					sSolucao& solucao,
 					const vector<vector<int>>& vviDistancias,
 					int iDeposito,
-					int iCapacidadeVeiculo
+					int iCapacidadeVeiculo,
+					const sOpcoesBuscaLocal& opcoes = sOpcoesBuscaLocal()
 ) 
 {
+    METRICA_FASE(FASE_BUSCA_LOCAL);
+    RASTREAR("buscaLocal");
 					
-    // Busca local intra-rota (já existente)
-    for (auto& rota : solucao.rotas) {
+    int iNumRotas = (int)solucao.rotas.size();
+    vector<int> viRotasIniciais;
+    if (opcoes.pRotasIniciais) {
+        viRotasIniciais = *opcoes.pRotasIniciais;
+    } else {
+        for (int r = 0; r < iNumRotas; ++r)
+            viRotasIniciais.push_back(r);
+    }
+
+    // Threads criadas uma unica vez para todas as rodadas desta busca
+    unique_ptr<sConjuntoThreads> pConjuntoProprio;
+    sConjuntoThreads* pConjunto = opcoes.pConjuntoThreads;
+    if (!pConjunto && opcoes.iNumThreads > 1) {
+        pConjuntoProprio = make_unique<sConjuntoThreads>(opcoes.iNumThreads);
+        pConjunto = pConjuntoProprio.get();
+    }
+
+    // Busca local intra-rota (já existente); as rotas sao independentes
+    executarEmParalelo(pConjunto, (int)viRotasIniciais.size(), opcoes.iNumThreads, [&](int iIndice) {
+        auto& rota = solucao.rotas[viRotasIniciais[iIndice]];
         auto& sequencia = rota.vsServicos;
         bool bMelhorou = true;
-        while (bMelhorou) {
+        while (bMelhorou && !opcoes.bInterromper()) {
             bMelhorou = false;
             if (twoOptTrecho(sequencia, vviDistancias, iDeposito)) { 
 				bMelhorou = true; 
@@ -257,115 +961,105 @@ void buscaLocal(
 			}
         }
         rota.custoTotal = custoRota(sequencia, vviDistancias, iDeposito);
-    }
+    });
+
+    if (opcoes.iNumThreads > 1)
+        buscaEntreRotasParalela(solucao, vviDistancias, iDeposito, iCapacidadeVeiculo, viRotasIniciais, opcoes, pConjunto);
     
-    // Busca local entre rotas (Relocate e Exchange)
-    bool bMelhoraGlobal = true;
-    while (bMelhoraGlobal) {
-        bMelhoraGlobal = false;
-        // Relocate: move um servico de uma rota para outra
-        for (int i = 0; i < (int)solucao.rotas.size(); ++i) {
-            for (int j = 0; j < (int)solucao.rotas.size(); ++j) {
-                if (i == j) 
-					continue;
-					
-                auto& rotaOriginal = solucao.rotas[i];
-                auto& rotaDestino = solucao.rotas[j];
-                for (int si = 0; si < (int)rotaOriginal.vsServicos.size(); ++si) {
-                    sServico servico = rotaOriginal.vsServicos[si];
-                    // So move se couber na rota destino
-                    if (rotaDestino.demandaTotal + servico.demanda > iCapacidadeVeiculo) continue;
-                    for (int pos = 0; pos <= (int)rotaDestino.vsServicos.size(); ++pos) {
-                        // Testa insercao
-                        auto sequenciaOriginal = rotaOriginal.vsServicos;
-                        auto sequenciaDestino = rotaDestino.vsServicos;
-                        
-                        sequenciaOriginal.erase(sequenciaOriginal.begin() + si);
-                        sequenciaDestino.insert(sequenciaDestino.begin() + pos, servico);
-                        
-                        double novoCustoOrigem = custoRota(sequenciaOriginal, vviDistancias, iDeposito);
-                        double novoCustoDestino = custoRota(sequenciaDestino, vviDistancias, iDeposito);
-                        
-                        double dGanho = (rotaOriginal.custoTotal + rotaDestino.custoTotal) - (novoCustoOrigem + novoCustoDestino);
-                        
-                        // Só aceita a troca se a melhoria for significativa 
-                        // (maior que 0.000001) para evitar aceitar diferenças 
-                        // causadas por imprecisão numérica 
-                        if (dGanho > 1e-6) {
-                            // Aplica movimento
-                            rotaOriginal.vsServicos = sequenciaOriginal;
-                            rotaDestino.vsServicos = sequenciaDestino;
-                            
-                            rotaOriginal.demandaTotal -= servico.demanda;
-                            rotaDestino.demandaTotal += servico.demanda;
-                            
-                            rotaOriginal.custoTotal = novoCustoOrigem;
-                            rotaDestino.custoTotal = novoCustoDestino;
-                            bMelhoraGlobal = true;
-                            break;
-                        }
-                    }
-                    if (bMelhoraGlobal) 
-						break;
-                }
-                if (bMelhoraGlobal) 
-					break;
-            }
-            if (bMelhoraGlobal) 
-				break;
+    // Busca local entre rotas guiada por uma fila de rotas alteradas: ao retirar a
+    // rota a, todos os pares (a, b) sao avaliados (Relocate e Exchange primeiro, depois
+    // Or-opt, 2-opt* e CROSS). Um movimento aplicado recoloca as duas rotas na fila e
+    // desliga o bit "nao olhar" apenas dos servicos cujos vizinhos mudaram. Os
+    // movimentos sao simetricos em (a, b), entao cada rota tem uma versao (quantos
+    // movimentos a alteraram) e cada par guarda as versoes da sua ultima avaliacao
+    // sem melhoria: pares cujas rotas nao mudaram desde entao nao sao reavaliados.
+    int iMaiorId = 0;
+    for (const auto& rota : solucao.rotas)
+        for (const auto& servico : rota.vsServicos)
+            iMaiorId = max(iMaiorId, servico.id);
+    vector<char> vbNaoOlhar(iMaiorId + 1, 0);
+    vector<int> viAntecessor(iMaiorId + 1, 0), viSucessor(iMaiorId + 1, 0);
+    deque<int> filaRotas;
+    vector<char> vbNaFila(iNumRotas, 0);
+    vector<int> viVersao(iNumRotas, 0);
+    // Versoes de (min, max) na ultima avaliacao sem melhoria, em vparAvaliadoEm[min * n + max]
+    vector<pair<int, int>> vparAvaliadoEm(opcoes.iNumThreads <= 1 ? (size_t)iNumRotas * iNumRotas : 0, {-1, -1});
+    for (int r : viRotasIniciais) {
+        vbNaFila[r] = 1;
+        filaRotas.push_back(r);
+    }
+
+    auto registrarVizinhos = [&](int r) {
+        const auto& vsServicos = solucao.rotas[r].vsServicos;
+        for (int k = 0; k < (int)vsServicos.size(); ++k) {
+            viAntecessor[vsServicos[k].id] = k > 0 ? vsServicos[k - 1].id : 0;
+            viSucessor[vsServicos[k].id] = k + 1 < (int)vsServicos.size() ? vsServicos[k + 1].id : 0;
         }
-        
-        if (bMelhoraGlobal) 
-			continue;
-        
-        // Exchange: troca servicos entre rotas
-        for (int i = 0; i < (int)solucao.rotas.size(); ++i) {
-            for (int j = i + 1; j < (int)solucao.rotas.size(); ++j) {
-                auto& rotaA = solucao.rotas[i];
-                auto& rotaB = solucao.rotas[j];
-                for (int iContadorA = 0; iContadorA < (int)rotaA.vsServicos.size(); ++iContadorA) {
-                    for (int iContadorB = 0; iContadorB < (int)rotaB.vsServicos.size(); ++iContadorB) {
-                        sServico servicoA = rotaA.vsServicos[iContadorA];
-                        sServico servicoB = rotaB.vsServicos[iContadorB];
-                        
-                        int novaDemA = rotaA.demandaTotal - servicoA.demanda + servicoB.demanda;
-                        int novaDemB = rotaB.demandaTotal - servicoB.demanda + servicoA.demanda;
-                        
-                        if (novaDemA > iCapacidadeVeiculo || novaDemB > iCapacidadeVeiculo) 
-							continue;
-                        
-                        auto seqA = rotaA.vsServicos;
-                        auto seqB = rotaB.vsServicos;
-                        
-                        seqA[iContadorA] = servicoB;
-                        seqB[iContadorB] = servicoA;
-                        
-                        double novoCustoA = custoRota(seqA, vviDistancias, iDeposito);
-                        double novoCustoB = custoRota(seqB, vviDistancias, iDeposito);
-                        
-                        double dGanho = (rotaA.custoTotal + rotaB.custoTotal) - (novoCustoA + novoCustoB);
-                        
-                        // Só aceita a troca se a melhoria for significativa 
-                        // (maior que 0.000001) para evitar aceitar diferenças 
-                        // causadas por imprecisão numérica 
-                        if (dGanho > 1e-6) {
-                            rotaA.vsServicos = seqA;
-                            rotaB.vsServicos = seqB;
-                            rotaA.demandaTotal = novaDemA;
-                            rotaB.demandaTotal = novaDemB;
-                            rotaA.custoTotal = novoCustoA;
-                            rotaB.custoTotal = novoCustoB;
-                            bMelhoraGlobal = true;
-                            break;
-                        }
-                    }
-                    if (bMelhoraGlobal) break;
-                }
-                if (bMelhoraGlobal) break;
+    };
+    auto liberarAlterados = [&](int r) {
+        const auto& vsServicos = solucao.rotas[r].vsServicos;
+        for (int k = 0; k < (int)vsServicos.size(); ++k) {
+            int iAntes = k > 0 ? vsServicos[k - 1].id : 0;
+            int iDepois = k + 1 < (int)vsServicos.size() ? vsServicos[k + 1].id : 0;
+            if (viAntecessor[vsServicos[k].id] != iAntes || viSucessor[vsServicos[k].id] != iDepois)
+                vbNaoOlhar[vsServicos[k].id] = 0;
+        }
+        viVersao[r]++;
+        if (!vbNaFila[r]) {
+            vbNaFila[r] = 1;
+            filaRotas.push_back(r);
+        }
+    };
+
+    while (opcoes.iNumThreads <= 1 && !filaRotas.empty() && !opcoes.bInterromper()) {
+        int a = filaRotas.front();
+        filaRotas.pop_front();
+        vbNaFila[a] = 0;
+        if (solucao.rotas[a].vsServicos.empty())
+            continue;
+
+        bool bAlterou = false, bInterrompido = false;
+        for (int b = 0; b < iNumRotas && !bAlterou; ++b) {
+            if (b == a || solucao.rotas[b].vsServicos.empty())
+                continue;
+            int iMenor = min(a, b), iMaior = max(a, b);
+            pair<int, int>& parAvaliadoEm = vparAvaliadoEm[(size_t)iMenor * iNumRotas + iMaior];
+            if (parAvaliadoEm == make_pair(viVersao[iMenor], viVersao[iMaior]))
+                continue;
+            // Cada par pode custar O(n^2) (CROSS): o prazo e conferido par a par
+            if (opcoes.bInterromper()) {
+                bInterrompido = true;
+                break;
+            }
+            sMovimento movimento;
+            {
+                sVisaoRota A(solucao.rotas[a], iDeposito);
+                sVisaoRota B(solucao.rotas[b], iDeposito);
+                avaliarRelocateExchange(A, B, a, b, vbNaoOlhar, vviDistancias, iCapacidadeVeiculo, movimento);
+            }
+            if (movimento.iGanho <= 0)
+                movimento = avaliarMovimentosEntreRotas(solucao, a, b, vviDistancias, iDeposito, iCapacidadeVeiculo);
+            if (movimento.iGanho > 0) {
+                registrarVizinhos(a);
+                registrarVizinhos(b);
+                aplicarMovimento(solucao, movimento, vviDistancias, iDeposito);
+                liberarAlterados(a);
+                liberarAlterados(b);
+                bAlterou = true;
+            } else {
+                parAvaliadoEm = {viVersao[iMenor], viVersao[iMaior]};
             }
-            if (bMelhoraGlobal) break;
         }
+        // Sem melhoria: os servicos de a ficam marcados ate seus vizinhos mudarem
+        if (!bAlterou && !bInterrompido)
+            for (const auto& servico : solucao.rotas[a].vsServicos)
+                vbNaoOlhar[servico.id] = 1;
     }
+
+    // Rotas esvaziadas pelos movimentos entre rotas sao descartadas
+    solucao.rotas.erase(remove_if(solucao.rotas.begin(), solucao.rotas.end(),
+                                  [](const sRota& rota) { return rota.vsServicos.empty(); }),
+                        solucao.rotas.end());
     
     // Atualiza custo total da solucao
     solucao.iCustoTotal = 0;
@@ -374,162 +1068,365 @@ void buscaLocal(
 }
 
 
-// Construcao de solucao por uma formiga
-sSolucao construirSolucao(
+// Construcao de solucao por uma formiga. Toda a memoria de trabalho (servicos
+// pendentes em estrutura de vetores, pesos) e a propria solucao vem da arena.
+sSolucaoPlana construirSolucao(
 							const sGrafo& grafo, 
+							const sTabelaServicos& tabela,
 							const vector<vector<int>>& vviDistancias, 
-							map<pair<int, int>, double>& dFeromonio
+							const sFeromonioCandidatos& feromonio,
+							const sParametrosACO& parametros,
+							sArena& arena
 )  {
-     // 1) extrai servicos e inicializa flags
-    vector<sServico> servicos = extrairServicos(grafo);
-    int iTamanho = (int)servicos.size();
-    vector<bool> vbAtendido(iTamanho, false);
-
-    // 2) Aqui: gen e dis sao criados UMA ÚNICA VEZ,
-    //    antes do laco principal
-    mt19937 gen(random_device{}());
+    int iTamanho = tabela.iTamanho();
+
+    sSolucaoPlana solucao;
+    solucao.piServicos = arena.alocar<int32_t>(iTamanho);
+    solucao.piInicioRotas = arena.alocar<int32_t>(iTamanho + 1);
+
+    // 1) servicos ainda nao atendidos (remocao por troca com o ultimo), com os
+    // dados usados pela roleta em vetores separados
+    int32_t* piPendentes = arena.alocar<int32_t>(iTamanho);
+    int32_t* piVertice1 = arena.alocar<int32_t>(iTamanho);
+    int32_t* piDemanda = arena.alocar<int32_t>(iTamanho);
+    int32_t* piCustoFixo = arena.alocar<int32_t>(iTamanho);
+    double* pdPesos = arena.alocar<double>(iTamanho);
+    // feromonio da linha atual indexado por servico: os candidatos da linha
+    // sao espalhados antes de cada passo e restaurados depois dele
+    double* pdFeromonioServicos = arena.alocar<double>(iTamanho);
+    fill(pdFeromonioServicos, pdFeromonioServicos + iTamanho, feromonio.dValorFora);
+    int iNumPendentes = iTamanho;
+    for (int i = 0; i < iTamanho; ++i) {
+        piPendentes[i] = i;
+        piVertice1[i] = tabela[i].iVertice1;
+        piDemanda[i] = tabela[i].demanda;
+        int iVolta = vviDistancias[tabela[i].iVertice2][grafo.deposito];
+        piCustoFixo[i] = iVolta == INF ? INF : (int32_t)min<int64_t>((int64_t)tabela[i].custo + iVolta, INF);
+    }
+    auto removerPendente = [&](int p) {
+        --iNumPendentes;
+        piPendentes[p] = piPendentes[iNumPendentes];
+        piVertice1[p] = piVertice1[iNumPendentes];
+        piDemanda[p] = piDemanda[iNumPendentes];
+        piCustoFixo[p] = piCustoFixo[iNumPendentes];
+    };
+
+    const sNucleosRoleta& nucleos = nucleosRoleta();
+    sEntradaRoleta entrada;
+    entrada.piVertice1 = piVertice1;
+    entrada.piChaveFeromonio = piPendentes;
+    entrada.piDemanda = piDemanda;
+    entrada.piCustoFixo = piCustoFixo;
+    entrada.dAlfa = parametros.dInfluenciaFeromonio;
+    entrada.dBeta = parametros.dInfluenciaHeuristica;
+
+    // 2) gerador criado uma unica vez por thread
+    static thread_local mt19937 gen(random_device{}());
     uniform_real_distribution<double> dis(0.0, 1.0);
 
-    sSolucao solucao;
     // <-- Comeca o loop que monta cada rota:
-    while (any_of(servicos.begin(), servicos.end(),
-                  [](const sServico& servico){ return !servico.atendido; })) {
-        sRota rota;
+    while (iNumPendentes > 0) {
+        solucao.piInicioRotas[solucao.iNumRotas] = solucao.iNumServicos;
+        int iDemandaRota = 0;
+        int iCustoRota = 0;
         int iAtual = grafo.deposito;
+        int iLinha = feromonio.iLinhaDeposito();
 
-        // 3) Selecao de candidatos
+        // 3) Pesos de todos os pendentes (zero para os que nao cabem) e roleta
         while (true) {
-            vector<sServico> vsCandidatos;
-            for (auto& servico : servicos) {
-                if (
-						!servico.atendido
-						&& rota.demandaTotal + servico.demanda <= grafo.capacidadeVeiculo
-				)
-                    vsCandidatos.push_back(servico);
+            entrada.iQuantidade = iNumPendentes;
+            entrada.piDistanciasAtual = vviDistancias[iAtual].data();
+            entrada.iCapacidadeRestante = grafo.capacidadeVeiculo - iDemandaRota;
+            const int32_t* piCandidatosLinha = feromonio.viCandidatos.data() + feromonio.viInicioLinha[iLinha];
+            const double* pdValoresLinha = feromonio.vdValores.data() + feromonio.viInicioLinha[iLinha];
+            int iTamanhoLinha = feromonio.viInicioLinha[iLinha + 1] - feromonio.viInicioLinha[iLinha];
+            bool bLinhaDeposito = iLinha == feromonio.iLinhaDeposito();
+            if (bLinhaDeposito) {
+                // a linha do deposito ja esta na ordem da tabela de servicos
+                entrada.pdFeromonioAtual = pdValoresLinha;
+            } else {
+                for (int c = 0; c < iTamanhoLinha; ++c)
+                    pdFeromonioServicos[piCandidatosLinha[c]] = pdValoresLinha[c];
+                entrada.pdFeromonioAtual = pdFeromonioServicos;
             }
-            
-            if (vsCandidatos.empty()) 
-				break;
+            int iNumCandidatos = 0;
+            double dSoma = nucleos.calcularPesos(entrada, pdPesos, iNumCandidatos);
+            if (!bLinhaDeposito)
+                for (int c = 0; c < iTamanhoLinha; ++c)
+                    pdFeromonioServicos[piCandidatosLinha[c]] = feromonio.dValorFora;
 
-            // cálculo de probabilidades…
-            vector<double> vdProbabilidades(vsCandidatos.size());
-            double dSoma = 0;
-            for (int i = 0; i < (int)vsCandidatos.size(); ++i) {
-                auto chave = make_pair(iAtual, vsCandidatos[i].iVertice1);
-                double f = pow(dFeromonio.at(chave), INFLUENCIA_FEROMONIO);
-                // custo mínimo de ir até o servico
-			    int iCustoIda = vviDistancias[iAtual][vsCandidatos[i].iVertice1];
-			    // custo mínimo de voltar ao deposito apos o servico
-			    int iCustoVolta = vviDistancias[vsCandidatos[i].iVertice2][grafo.deposito];
-			    int iCustoInclusao = iCustoIda + 
-								  vsCandidatos[i].custo + 
-								  iCustoVolta;
-								
-                double h = pow(1.0 / (iCustoInclusao + 1), INFLUENCIA_HEURISTICA);
-				vdProbabilidades[i] = f * h;
-                dSoma += vdProbabilidades[i];
-            }
+            if (iNumCandidatos == 0) 
+				break;
+            METRICA_CONTAR(CONT_CANDIDATOS_AVALIADOS, iNumCandidatos);
+            METRICA_CONTAR(CONT_GIROS_ROLETA, 1);
 
-            // roleta usando o **mesmo** gen e dis
-            double dRoleta = dis(gen) * dSoma;
-            double dCumulativo = 0;
-            
-            int idEscolhido = (int)vdProbabilidades.size() - 1;
-            
-            for (int i = 0; i < (int)vdProbabilidades.size(); ++i) {
-                dCumulativo += vdProbabilidades[i];
-                
-                if (dRoleta <= dCumulativo) { 
-					idEscolhido = (int)i; 
-					break; 
-				}
+            // roleta em (0, soma]: a posicao escolhida sempre tem peso positivo
+            int iPosicao = dSoma > 0 ? nucleos.escolher(pdPesos, iNumPendentes, (1.0 - dis(gen)) * dSoma) : -1;
+            if (iPosicao < 0) {
+                // arredondamento na soma (ou todos os pesos nulos): ultimo candidato
+                iPosicao = iNumPendentes - 1;
+                while (iPosicao > 0 && (dSoma > 0 ? pdPesos[iPosicao] <= 0 : piDemanda[iPosicao] > entrada.iCapacidadeRestante))
+                    iPosicao--;
             }
 
             // marca e avanca…
-            sServico& servicoSelecionado = vsCandidatos[idEscolhido];
-            for (auto& servico : servicos)
-                if (servico.id == servicoSelecionado.id) { 
-					servico.atendido = true; 
-					break; 
-				}
-            rota.vsServicos.push_back(servicoSelecionado);
-            rota.demandaTotal += servicoSelecionado.demanda;
-            rota.custoTotal   += vviDistancias[iAtual][servicoSelecionado.iVertice1] + servicoSelecionado.custo;
+            int iServico = piPendentes[iPosicao];
+            removerPendente(iPosicao);
+
+            const sServico& servicoSelecionado = tabela[iServico];
+            solucao.piServicos[solucao.iNumServicos++] = iServico;
+            iDemandaRota += servicoSelecionado.demanda;
+            iCustoRota   += vviDistancias[iAtual][servicoSelecionado.iVertice1] + servicoSelecionado.custo;
             iAtual = servicoSelecionado.iVertice2;
+            iLinha = iServico;
         }
 
-        rota.custoTotal += vviDistancias[iAtual][grafo.deposito];
-        solucao.iCustoTotal += rota.custoTotal;
-        solucao.rotas.push_back(rota);
+        iCustoRota += vviDistancias[iAtual][grafo.deposito];
+        solucao.iCustoTotal += iCustoRota;
+        solucao.iNumRotas++;
     }
+    solucao.piInicioRotas[solucao.iNumRotas] = solucao.iNumServicos;
 
     return solucao;
 }
 
+// Acumula no buffer o deposito de uma solucao plana ao longo de suas rotas.
+// Pares fora das listas de candidatos nao recebem deposito, e a volta ao
+// deposito nao e escolhida pela roleta, entao tambem nao recebe.
+void acumularDeposito(
+						sBufferDelta& delta,
+						const sFeromonioCandidatos& feromonio,
+						const int32_t* piServicos,
+						const int32_t* piInicioRotas,
+						int iNumRotas,
+						double dDeposito
+) {
+    for (int r = 0; r < iNumRotas; ++r) {
+        int iLinha = feromonio.iLinhaDeposito();
+        for (int p = piInicioRotas[r]; p < piInicioRotas[r + 1]; ++p) {
+            int64_t iChave = feromonio.iChave(iLinha, piServicos[p]);
+            if (iChave >= 0)
+                delta.acumular(iChave, dDeposito);
+            iLinha = piServicos[p];
+        }
+    }
+}
+
+void acumularDeposito(sBufferDelta& delta, const sFeromonioCandidatos& feromonio,
+                      const sSolucaoPlanaIncumbente& solucao, double dDeposito) {
+    acumularDeposito(delta, feromonio, solucao.viServicos.data(), solucao.viInicioRotas.data(),
+                     solucao.iNumRotas(), dDeposito);
+}
+
+// Converte uma solucao com rotas (por exemplo, apos a busca local) de volta para
+// a forma plana. Os servicos sao identificados pelo id (indice + 1 na tabela).
+void converterParaPlana(const sSolucao& solucao, sSolucaoPlanaIncumbente& solucaoPlana) {
+    solucaoPlana.viServicos.clear();
+    solucaoPlana.viInicioRotas.clear();
+    for (const sRota& rota : solucao.rotas) {
+        solucaoPlana.viInicioRotas.push_back((int32_t)solucaoPlana.viServicos.size());
+        for (const sServico& servico : rota.vsServicos)
+            solucaoPlana.viServicos.push_back(servico.id - 1);
+    }
+    solucaoPlana.viInicioRotas.push_back((int32_t)solucaoPlana.viServicos.size());
+    solucaoPlana.iCustoTotal = solucao.iCustoTotal;
+}
+
+// Busca local nas formigas de elite da iteracao, em paralelo (nas threads do
+// conjunto) e limitada ao prazo informado. As solucoes sao substituidas pelas
+// versoes melhoradas.
+void aplicarBuscaLocalElite(
+								const vector<sSolucaoPlanaIncumbente*>& vpElite,
+								const sGrafo& grafo,
+								const sTabelaServicos& tabela,
+								const vector<vector<int>>& vviDistancias,
+								int iNumThreads,
+								sConjuntoThreads* pConjunto,
+								const sOpcoesBuscaLocal& opcoes
+) {
+    executarEmParalelo(pConjunto, (int)vpElite.size(), iNumThreads, [&](int iIndice) {
+        sSolucao solucao = sConverterSolucaoPlana(*vpElite[iIndice], tabela, vviDistancias, grafo.deposito);
+        buscaLocal(solucao, vviDistancias, grafo.deposito, grafo.capacidadeVeiculo, opcoes);
+        if (solucao.iCustoTotal < vpElite[iIndice]->iCustoTotal)
+            converterParaPlana(solucao, *vpElite[iIndice]);
+    });
+}
+
+// Estado de trabalho de cada thread do ACO, preservado entre iteracoes para
+// que a memoria reservada nas primeiras iteracoes seja reaproveitada
+struct sEstadoThreadACO {
+    sArena arena;
+    sBufferDelta delta;
+    sColetorMelhores melhores;
+    sSolucaoPlanaIncumbente melhor;
+};
+
 // Funcao principal do ACO
-sSolucao executarACO(const sGrafo& Grafo, const vector<vector<int>>& vviDistancias, int iNumFormigas, int iNumIteracoes, double dInfluenciaFeromonio, double dInfluenciaHeuristica) {
-    int iNumeroVertices = Grafo.iNumVertices + 1;
-    map<pair<int, int>, double> feromonio;
-    
-	for (int i = 0; i < iNumeroVertices; ++i)
-		for (int j = 0; j < iNumeroVertices; ++j)
-			feromonio[{i, j}] = 1.0;
+sSolucao executarACO(const sGrafo& Grafo, const vector<vector<int>>& vviDistancias, const sParametrosACO& parametros) {
+    METRICA_FASE(FASE_ACO);
+    const sTabelaServicos tabela = sCriarTabelaServicos(Grafo);
+    sFeromonioCandidatos feromonio;
+    feromonio.inicializar(tabela, vviDistancias, parametros.iVizinhosFeromonio, FEROMONIO_INICIAL);
+
+    bool bUsaRanking = parametros.ePolitica != DEPOSITO_TODAS;
+    int iNumElite = max(0, parametros.iEliteBuscaLocal);
+    bool bColetaMelhores = bUsaRanking || iNumElite > 0;
+    int iTamanhoColeta = max(bUsaRanking ? parametros.iTopK : 0, iNumElite);
+    int iNumThreads = max(1, min(parametros.iNumThreads, parametros.iNumFormigas));
+
+    vector<sEstadoThreadACO> vsEstados(iNumThreads);
+    for (auto& estado : vsEstados) {
+        estado.melhor.reservar(tabela.iTamanho());
+        if (bColetaMelhores)
+            estado.melhores.configurar(iTamanhoColeta, tabela.iTamanho());
+    }
+    vector<sSolucaoPlanaIncumbente*> vpRanking;
+    vector<sSolucaoPlanaIncumbente*> vpElite;
 
-    sSolucao melhorSolucao;
-    melhorSolucao.iCustoTotal = INF;
+    // Threads das formigas e da busca local de elite, criadas uma vez e
+    // reaproveitadas em todas as iteracoes
+    int iThreadsElite = max(1, min(parametros.iNumThreads, iNumElite));
+    unique_ptr<sConjuntoThreads> pConjunto;
+    if (max(iNumThreads, iThreadsElite) > 1)
+        pConjunto = make_unique<sConjuntoThreads>(max(iNumThreads, iThreadsElite));
+
+    sSolucaoPlanaIncumbente melhorSolucao;
+    melhorSolucao.reservar(tabela.iTamanho());
+
+    // Partida quente: a solucao conhecida vira a incumbente (com o custo na
+    // orientacao da tabela de servicos) e suas ligacoes recebem um reforco de
+    // feromonio antes da primeira iteracao
+    if (parametros.pSolucaoInicial && !parametros.pSolucaoInicial->rotas.empty()) {
+        converterParaPlana(*parametros.pSolucaoInicial, melhorSolucao);
+        melhorSolucao.iCustoTotal = sConverterSolucaoPlana(melhorSolucao, tabela, vviDistancias, Grafo.deposito).iCustoTotal;
+        acumularDeposito(vsEstados[0].delta, feromonio, melhorSolucao, parametros.dReforcoSolucaoInicial * FEROMONIO_INICIAL);
+        vsEstados[0].delta.aplicar(feromonio);
+    }
 
     // Critério de parada inteligente
     const int MAX_SEM_MELHORA = 50;
     int semMelhora = 0;
     int ultimaMelhor = -1;
 
-    for (int iteracao = 0; iteracao < iNumIteracoes; ++iteracao) {
-        vector<sSolucao> vsPopulacaoSolucoes;
+    for (int iteracao = 0; iteracao < parametros.iNumIteracoes; ++iteracao) {
+        // Cancelamento: a primeira iteracao sempre roda para haver uma solucao viavel
+        if (iteracao > 0 && parametros.pCancelamento && parametros.pCancelamento->bCancelado())
+            break;
+        METRICA_CONTAR(CONT_ITERACOES_ACO, 1);
+        RASTREAR_ITERACAO("iteracaoACO", iteracao);
+        atomic<int> iProximaFormiga(0);
+
+        // Cada formiga e construida, contabilizada e descartada em seguida:
+        // nenhuma populacao e mantida viva ate o fim da iteracao
+        auto executarFormigas = [&](sEstadoThreadACO& estado) {
+            estado.arena.reiniciar();
+            estado.melhor.iCustoTotal = INF;
+            estado.melhores.iQuantidade = 0;
+            while (iProximaFormiga.fetch_add(1) < parametros.iNumFormigas) {
+                auto marca = estado.arena.marcar();
+                sSolucaoPlana solucao = construirSolucao(Grafo, tabela, vviDistancias, feromonio, parametros, estado.arena);
+                if (solucao.iCustoTotal < estado.melhor.iCustoTotal)
+                    estado.melhor.copiar(solucao);
+                if (bColetaMelhores)
+                    estado.melhores.considerar(solucao);
+                if (!bUsaRanking)
+                    acumularDeposito(estado.delta, feromonio, solucao.piServicos, solucao.piInicioRotas,
+                                     solucao.iNumRotas, 1.0 / solucao.iCustoTotal);
+                estado.arena.liberarAte(marca);
+            }
+        };
+
+        {
+            METRICA_FASE(FASE_ACO_CONSTRUCAO);
+            executarEmParalelo(pConjunto.get(), iNumThreads, iNumThreads, [&](int t) { executarFormigas(vsEstados[t]); });
+        }
 
-        for (int formiga = 0; formiga < iNumFormigas; ++formiga) {
-            sSolucao solucao = construirSolucao(Grafo, vviDistancias, feromonio);
-            if (solucao.iCustoTotal < melhorSolucao.iCustoTotal) {
-                melhorSolucao = solucao;
+        for (const auto& estado : vsEstados) {
+            if (estado.melhor.iCustoTotal < melhorSolucao.iCustoTotal) {
+                melhorSolucao = estado.melhor;
                 semMelhora = 0;
                 ultimaMelhor = iteracao;
             }
-            vsPopulacaoSolucoes.push_back(solucao);
         }
 
-        // Evaporacao
-        for (auto& par : feromonio)
-			par.second *= (1.0 - TAXA_EVAPORACAO_FEROMONIO);
-
-        // Atualiza feromônio com base nas solucoes
-        for (const auto& solucao : vsPopulacaoSolucoes) {
-            for (const auto& rota : solucao.rotas) {
-                int atual = Grafo.deposito;
-                for (const auto& servico : rota.vsServicos) {
-                    feromonio[{atual, servico.iVertice1}] += 1.0 / solucao.iCustoTotal;
-                    atual = servico.iVertice2;
+        // Une as k melhores formigas de todas as threads, da melhor para a pior
+        int iK = 0;
+        if (bColetaMelhores) {
+            vpRanking.clear();
+            for (auto& estado : vsEstados)
+                for (int i = 0; i < estado.melhores.iQuantidade; ++i)
+                    vpRanking.push_back(&estado.melhores.vsSolucoes[i]);
+            iK = min((int)vpRanking.size(), iTamanhoColeta);
+            auto porCusto = [](const sSolucaoPlanaIncumbente* a, const sSolucaoPlanaIncumbente* b) {
+                return a->iCustoTotal < b->iCustoTotal;
+            };
+            partial_sort(vpRanking.begin(), vpRanking.begin() + iK, vpRanking.end(), porCusto);
+
+            // Busca local de elite antes da atualizacao do feromonio
+            if (iNumElite > 0) {
+                vpElite.assign(vpRanking.begin(), vpRanking.begin() + min(iK, iNumElite));
+                sOpcoesBuscaLocal opcoesElite;
+                opcoesElite.pCancelamento = parametros.pCancelamento;
+                opcoesElite.tPrazo = chrono::steady_clock::now() +
+                    chrono::microseconds((long long)(parametros.dLimiteBuscaLocalMs * 1000.0));
+                aplicarBuscaLocalElite(vpElite, Grafo, tabela, vviDistancias, iThreadsElite, pConjunto.get(), opcoesElite);
+                sort(vpRanking.begin(), vpRanking.begin() + iK, porCusto);
+                if (vpRanking[0]->iCustoTotal < melhorSolucao.iCustoTotal) {
+                    melhorSolucao = *vpRanking[0];
+                    semMelhora = 0;
+                    ultimaMelhor = iteracao;
                 }
-                feromonio[{atual, Grafo.deposito}] += 1.0 / solucao.iCustoTotal;
             }
         }
-        
-        // Reforco da melhor solucao global (elitismo)
-        for (const auto& rota : melhorSolucao.rotas) {
-            int atual = Grafo.deposito;
-            for (const auto& servico : rota.vsServicos) {
-                feromonio[{atual, servico.iVertice1}] += 1.0 / melhorSolucao.iCustoTotal;
-                atual = servico.iVertice2;
+
+        // Criterio de parada por gap: a incumbente ja esta provadamente perto do otimo
+        if (parametros.dGapAlvo >= 0 && parametros.iLimitanteInferior > 0) {
+            double dGap = (double)(melhorSolucao.iCustoTotal - parametros.iLimitanteInferior) / parametros.iLimitanteInferior;
+            if (dGap <= parametros.dGapAlvo) {
+                if (parametros.bExibirProgresso)
+                    cout << "Parando antecipadamente: gap " << dGap << " <= alvo " << parametros.dGapAlvo
+                         << " na iteracao " << iteracao << ".\n";
+                break;
+            }
+        }
+
+        METRICA_FASE(FASE_ACO_FEROMONIO);
+        METRICA_CONTAR(CONT_ATUALIZACOES_FEROMONIO, 1);
+
+        // Evaporacao
+        feromonio.evaporar(parametros.dTaxaEvaporacao);
+
+        // Deposito das k melhores formigas da iteracao (RANK e TOP_K). Na politica
+        // TODAS as formigas ja depositaram; as de elite melhoradas reforcam o deposito.
+        double dPesoElitista = 1.0;
+        if (bUsaRanking) {
+            for (int r = 0; r < min(iK, parametros.iTopK); ++r) {
+                double dPeso = parametros.ePolitica == DEPOSITO_RANK ? (double)(parametros.iTopK - r) : 1.0;
+                acumularDeposito(vsEstados[0].delta, feromonio, *vpRanking[r], dPeso / vpRanking[r]->iCustoTotal);
             }
-            feromonio[std::make_pair(atual, Grafo.deposito)] += 1.0 / melhorSolucao.iCustoTotal;
+            if (parametros.ePolitica == DEPOSITO_RANK)
+                dPesoElitista = parametros.iTopK + 1;
+        } else {
+            for (const sSolucaoPlanaIncumbente* pElite : vpElite)
+                acumularDeposito(vsEstados[0].delta, feromonio, *pElite, 1.0 / pElite->iCustoTotal);
         }
 
+        // Reforco da melhor solucao global (elitismo)
+        acumularDeposito(vsEstados[0].delta, feromonio, melhorSolucao, dPesoElitista / melhorSolucao.iCustoTotal);
+
+        // Atualiza feromônio: os buffers de cada thread sao aplicados uma unica vez
+        for (auto& estado : vsEstados)
+            estado.delta.aplicar(feromonio);
+
         semMelhora++;
         if (semMelhora >= MAX_SEM_MELHORA) {
-            cout << "Parando antecipadamente por falta de melhora apos " << MAX_SEM_MELHORA << " iteracoes.\n";
+            if (parametros.bExibirProgresso)
+                cout << "Parando antecipadamente por falta de melhora apos " << MAX_SEM_MELHORA << " iteracoes.\n";
             break;
         }
     }
 
-    return melhorSolucao;
+    return sConverterSolucaoPlana(melhorSolucao, tabela, vviDistancias, Grafo.deposito);
 }
 
 // Imprime uma única rota
@@ -558,22 +1455,16 @@ void imprimirSolucao(const sSolucao& sSolucao) {
     }
 }
 
-void salvarSolucaoDat(
+// Escreve a solucao no formato dos arquivos sol-*.dat em qualquer fluxo
+void escreverSolucaoDat(
+						 ostream& ofs,
 						 const sSolucao& sSolucao,
 						 int iDeposito,
 						 int iDia,
 						 long lClockExecucaoReferencia,
-						 long lClockParaAcharSolucaoRef,
-						 const string& sNomeArquivo
+						 long lClockParaAcharSolucaoRef
 					 )
 {
-	string sDiretorioSolucao = "./solucoes/";
-    ofstream ofs(sDiretorioSolucao + sNomeArquivo);
-    if (!ofs.is_open()) {
-        cerr << "Erro ao abrir o arquivo para escrita: " << sNomeArquivo << "\n";
-        return;
-    }
-
     // 1) cabecalho
     ofs << sSolucao.iCustoTotal        << "\n"  // custo total da solucao
         << sSolucao.rotas.size()      << "\n"  // total de rotas
@@ -611,6 +1502,24 @@ void salvarSolucaoDat(
         // tripla final de deposito
         ofs << " (D " << 0 << "," << iDeposito << "," << iDeposito << ")\n";
     }
+}
 
+void salvarSolucaoDat(
+						 const sSolucao& sSolucao,
+						 int iDeposito,
+						 int iDia,
+						 long lClockExecucaoReferencia,
+						 long lClockParaAcharSolucaoRef,
+						 const string& sNomeArquivo
+					 )
+{
+    RASTREAR("salvarSolucaoDat");
+	string sDiretorioSolucao = "./solucoes/";
+    ofstream ofs(sDiretorioSolucao + sNomeArquivo);
+    if (!ofs.is_open()) {
+        cerr << "Erro ao abrir o arquivo para escrita: " << sNomeArquivo << "\n";
+        return;
+    }
+    escreverSolucaoDat(ofs, sSolucao, iDeposito, iDia, lClockExecucaoReferencia, lClockParaAcharSolucaoRef);
     ofs.close();
 }
@@ -0,0 +1,304 @@
+#include "grafo.hpp"
+#include "solucao.hpp"
+#include "metricas.hpp"
+#include <vector>
+#include <string>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+// Heuristicas construtivas deterministicas, para obter em milissegundos uma
+// solucao usada diretamente (com busca local) ou como semente do ACO
+// (sParametrosACO::pSolucaoInicial). Depende de colonia_formigas.cpp
+// (extrairServicos, atualizarRota).
+
+// Criterios de desempate do path-scanning (Golden, DeArmon e Baker, 1983)
+// entre os servicos viaveis mais proximos do fim da rota
+enum eRegraPathScanning {
+    PS_LONGE_DEPOSITO,    // maior distancia do fim do servico ate o deposito
+    PS_PERTO_DEPOSITO,    // menor distancia do fim do servico ate o deposito
+    PS_MAIOR_RAZAO,       // maior demanda / custo de atendimento
+    PS_MENOR_RAZAO,       // menor demanda / custo de atendimento
+    PS_METADE_CAPACIDADE, // longe do deposito ate metade da capacidade, perto depois
+    NUM_REGRAS_PATH_SCANNING
+};
+
+const char* vsNomesRegrasPathScanning[NUM_REGRAS_PATH_SCANNING] = {
+    "longeDeposito", "pertoDeposito", "maiorRazao", "menorRazao", "metadeCapacidade"
+};
+
+// Path-scanning com uma regra de desempate: cada rota parte do deposito e
+// cresce pelo servico viavel cujo inicio esta mais perto do fim da rota
+// (arestas nos dois sentidos); sem candidato viavel, a rota volta ao deposito.
+// O(S^2) no total.
+sSolucao sPathScanning(
+						const vector<sServico>& vsServicos,
+						const vector<vector<int>>& vviDistancias,
+						int iDeposito,
+						int iCapacidadeVeiculo,
+						eRegraPathScanning regra
+) {
+    sSolucao solucao;
+    vector<int> viPendentes(vsServicos.size());
+    for (size_t i = 0; i < vsServicos.size(); ++i)
+        viPendentes[i] = (int)i;
+
+    // true se o candidato b (fim iFimB) desempata melhor que a (fim iFimA)
+    auto bPreferir = [&](const sServico& b, int iFimB, const sServico& a, int iFimA, int iCarga) {
+        eRegraPathScanning regraEfetiva = regra;
+        if (regra == PS_METADE_CAPACIDADE)
+            regraEfetiva = 2 * iCarga < iCapacidadeVeiculo ? PS_LONGE_DEPOSITO : PS_PERTO_DEPOSITO;
+        long long lRazaoB = (long long)b.demanda * max(a.custo, 1), lRazaoA = (long long)a.demanda * max(b.custo, 1);
+        switch (regraEfetiva) {
+            case PS_LONGE_DEPOSITO: return vviDistancias[iFimB][iDeposito] > vviDistancias[iFimA][iDeposito];
+            case PS_PERTO_DEPOSITO: return vviDistancias[iFimB][iDeposito] < vviDistancias[iFimA][iDeposito];
+            case PS_MAIOR_RAZAO: return lRazaoB > lRazaoA;
+            case PS_MENOR_RAZAO: return lRazaoB < lRazaoA;
+            default: return false;
+        }
+    };
+
+    while (!viPendentes.empty()) {
+        sRota rota;
+        int iAtual = iDeposito, iCarga = 0;
+        while (true) {
+            int iEscolhido = -1, iMelhorDistancia = INF, iFimEscolhido = 0;
+            bool bInverterEscolhido = false;
+            for (int p = 0; p < (int)viPendentes.size(); ++p) {
+                const sServico& servico = vsServicos[viPendentes[p]];
+                if (iCarga + servico.demanda > iCapacidadeVeiculo)
+                    continue;
+                for (int iSentido = 0; iSentido < (servico.bAresta ? 2 : 1); ++iSentido) {
+                    int iInicio = iSentido ? servico.iVertice2 : servico.iVertice1;
+                    int iFim = iSentido ? servico.iVertice1 : servico.iVertice2;
+                    int iDistancia = vviDistancias[iAtual][iInicio];
+                    if (iDistancia == INF || vviDistancias[iFim][iDeposito] == INF)
+                        continue;
+                    if (iEscolhido < 0 || iDistancia < iMelhorDistancia ||
+                        (iDistancia == iMelhorDistancia &&
+                         bPreferir(servico, iFim, vsServicos[viPendentes[iEscolhido]], iFimEscolhido, iCarga))) {
+                        iEscolhido = p;
+                        iMelhorDistancia = iDistancia;
+                        iFimEscolhido = iFim;
+                        bInverterEscolhido = iSentido == 1;
+                    }
+                }
+            }
+            if (iEscolhido < 0)
+                break;
+            sServico servico = vsServicos[viPendentes[iEscolhido]];
+            if (bInverterEscolhido)
+                swap(servico.iVertice1, servico.iVertice2);
+            servico.atendido = true;
+            rota.vsServicos.push_back(servico);
+            iCarga += servico.demanda;
+            iAtual = servico.iVertice2;
+            viPendentes[iEscolhido] = viPendentes.back();
+            viPendentes.pop_back();
+        }
+        // Nenhum servico cabe em um veiculo vazio (ou nenhum e alcancavel):
+        // os restantes ficam de fora
+        if (rota.vsServicos.empty())
+            break;
+        atualizarRota(rota, vviDistancias, iDeposito);
+        solucao.iCustoTotal += rota.custoTotal;
+        solucao.rotas.push_back(move(rota));
+    }
+    return solucao;
+}
+
+// Roda as cinco regras em paralelo e devolve a solucao de menor custo (em
+// empate, a da regra de menor indice, entao o resultado nao depende do
+// numero de threads)
+sSolucao sPathScanningParalelo(
+								const vector<sServico>& vsServicos,
+								const vector<vector<int>>& vviDistancias,
+								int iDeposito,
+								int iCapacidadeVeiculo,
+								int iNumThreads,
+								int* pRegraVencedora = nullptr
+) {
+    vector<sSolucao> vsSolucoes(NUM_REGRAS_PATH_SCANNING);
+    atomic<int> iProxima(0);
+    auto trabalhar = [&]() {
+        int iRegra;
+        while ((iRegra = iProxima.fetch_add(1)) < NUM_REGRAS_PATH_SCANNING)
+            vsSolucoes[iRegra] = sPathScanning(vsServicos, vviDistancias, iDeposito, iCapacidadeVeiculo, (eRegraPathScanning)iRegra);
+    };
+    int iThreadsUsadas = max(1, min(iNumThreads, (int)NUM_REGRAS_PATH_SCANNING));
+    vector<thread> vThreads;
+    for (int t = 1; t < iThreadsUsadas; ++t)
+        vThreads.emplace_back(trabalhar);
+    trabalhar();
+    for (auto& th : vThreads)
+        th.join();
+
+    int iMelhor = 0;
+    for (int r = 1; r < NUM_REGRAS_PATH_SCANNING; ++r)
+        if (vsSolucoes[r].iCustoTotal < vsSolucoes[iMelhor].iCustoTotal)
+            iMelhor = r;
+    if (pRegraVencedora)
+        *pRegraVencedora = iMelhor;
+    return vsSolucoes[iMelhor];
+}
+
+// Ligacao candidata do savings: o servico j logo depois do servico i, cada um
+// em um sentido (1 = aresta atendida de iVertice2 para iVertice1)
+struct sEconomia {
+    int iEconomia;
+    int i, j;
+    int8_t iSentidoI, iSentidoJ;
+
+    // ordem do heap: maior economia primeiro; empates pelos indices, para
+    // que o resultado seja deterministico
+    bool operator<(const sEconomia& outra) const {
+        if (iEconomia != outra.iEconomia) return iEconomia < outra.iEconomia;
+        if (i != outra.i) return i > outra.i;
+        if (j != outra.j) return j > outra.j;
+        return iSentidoI * 2 + iSentidoJ > outra.iSentidoI * 2 + outra.iSentidoJ;
+    }
+};
+
+// Savings (Clarke e Wright) para servicos: cada servico comeca em uma rota
+// propria e as rotas sao unidas, em ordem decrescente de economia
+// d(fim de i, deposito) + d(deposito, inicio de j) - d(fim de i, inicio de j),
+// quando i ainda e o ultimo servico da sua rota, j o primeiro da outra e a
+// demanda somada cabe no veiculo. As rotas sao mantidas por union-find com o
+// primeiro/ultimo servico e a demanda em cada raiz. O sentido de uma aresta so
+// e fixado quando ela entra em uma uniao. O(S^2 log S).
+sSolucao sSavings(
+					const vector<sServico>& vsServicos,
+					const vector<vector<int>>& vviDistancias,
+					int iDeposito,
+					int iCapacidadeVeiculo
+) {
+    int iNumServicos = (int)vsServicos.size();
+    auto iInicio = [&](int i, int iSentido) { return iSentido ? vsServicos[i].iVertice2 : vsServicos[i].iVertice1; };
+    auto iFim = [&](int i, int iSentido) { return iSentido ? vsServicos[i].iVertice1 : vsServicos[i].iVertice2; };
+    auto iNumSentidos = [&](int i) { return vsServicos[i].bAresta ? 2 : 1; };
+
+    vector<int> viPai(iNumServicos), viPrimeiro(iNumServicos), viUltimo(iNumServicos), viDemanda(iNumServicos);
+    vector<int> viProximo(iNumServicos, -1);
+    vector<int8_t> viSentido(iNumServicos, -1); // -1: ainda livre
+    for (int i = 0; i < iNumServicos; ++i) {
+        viPai[i] = viPrimeiro[i] = viUltimo[i] = i;
+        viDemanda[i] = vsServicos[i].demanda;
+    }
+    auto iRaiz = [&](int i) {
+        while (viPai[i] != i) {
+            viPai[i] = viPai[viPai[i]];
+            i = viPai[i];
+        }
+        return i;
+    };
+
+    // Melhor combinacao de sentidos de (i, j) compativel com os sentidos ja
+    // fixados; economia <= 0 se nenhuma vale a pena
+    auto bMelhorEconomia = [&](int i, int j, sEconomia& economia) {
+        economia = {0, i, j, 0, 0};
+        for (int8_t si = 0; si < iNumSentidos(i); ++si) {
+            if (viSentido[i] >= 0 && viSentido[i] != si)
+                continue;
+            for (int8_t sj = 0; sj < iNumSentidos(j); ++sj) {
+                if (viSentido[j] >= 0 && viSentido[j] != sj)
+                    continue;
+                int iVolta = vviDistancias[iFim(i, si)][iDeposito];
+                int iIda = vviDistancias[iDeposito][iInicio(j, sj)];
+                int iLigacao = vviDistancias[iFim(i, si)][iInicio(j, sj)];
+                if (iVolta == INF || iIda == INF || iLigacao == INF)
+                    continue;
+                long long lEconomia = (long long)iVolta + iIda - iLigacao;
+                if (lEconomia > economia.iEconomia)
+                    economia = {(int)min<long long>(lEconomia, INF), i, j, si, sj};
+            }
+        }
+        return economia.iEconomia > 0;
+    };
+
+    // Uma entrada por par (i, j), com a melhor combinacao de sentidos; se um
+    // sentido for fixado depois, a entrada e reavaliada ao sair do heap
+    vector<sEconomia> vsHeap;
+    vsHeap.reserve((size_t)iNumServicos * max(iNumServicos - 1, 0) / 2);
+    sEconomia economia;
+    for (int i = 0; i < iNumServicos; ++i)
+        for (int j = 0; j < iNumServicos; ++j)
+            if (i != j && bMelhorEconomia(i, j, economia))
+                vsHeap.push_back(economia);
+    make_heap(vsHeap.begin(), vsHeap.end());
+
+    while (!vsHeap.empty()) {
+        pop_heap(vsHeap.begin(), vsHeap.end());
+        economia = vsHeap.back();
+        vsHeap.pop_back();
+        int a = iRaiz(economia.i), b = iRaiz(economia.j);
+        if (a == b || viUltimo[a] != economia.i || viPrimeiro[b] != economia.j)
+            continue;
+        if (viDemanda[a] + viDemanda[b] > iCapacidadeVeiculo)
+            continue;
+        if ((viSentido[economia.i] >= 0 && viSentido[economia.i] != economia.iSentidoI) ||
+            (viSentido[economia.j] >= 0 && viSentido[economia.j] != economia.iSentidoJ)) {
+            if (bMelhorEconomia(economia.i, economia.j, economia)) {
+                vsHeap.push_back(economia);
+                push_heap(vsHeap.begin(), vsHeap.end());
+            }
+            continue;
+        }
+        viSentido[economia.i] = economia.iSentidoI;
+        viSentido[economia.j] = economia.iSentidoJ;
+        viProximo[economia.i] = economia.j;
+        viPai[b] = a;
+        viUltimo[a] = viUltimo[b];
+        viDemanda[a] += viDemanda[b];
+    }
+
+    sSolucao solucao;
+    for (int i = 0; i < iNumServicos; ++i) {
+        if (iRaiz(i) != i)
+            continue;
+        // Servico maior que a capacidade (sempre isolado) ou inalcancavel fica de fora
+        if (viDemanda[i] > iCapacidadeVeiculo)
+            continue;
+        sRota rota;
+        for (int k = viPrimeiro[i]; k >= 0; k = viProximo[k]) {
+            int iSentidoK = viSentido[k];
+            if (iSentidoK < 0) // rota de um servico so: o sentido mais barato
+                iSentidoK = iNumSentidos(k) == 2 &&
+                            (long long)vviDistancias[iDeposito][iInicio(k, 1)] + vviDistancias[iFim(k, 1)][iDeposito] <
+                            (long long)vviDistancias[iDeposito][iInicio(k, 0)] + vviDistancias[iFim(k, 0)][iDeposito];
+            sServico servico = vsServicos[k];
+            if (iSentidoK == 1)
+                swap(servico.iVertice1, servico.iVertice2);
+            servico.atendido = true;
+            rota.vsServicos.push_back(servico);
+        }
+        atualizarRota(rota, vviDistancias, iDeposito);
+        solucao.iCustoTotal += rota.custoTotal;
+        solucao.rotas.push_back(move(rota));
+    }
+    return solucao;
+}
+
+// Construtivos disponiveis pela linha de comando (--construtivo e --semente)
+const vector<string> vsConstrutivos = {"path-scanning", "savings"};
+
+bool bConstrutivoConhecido(const string& sNome) {
+    return find(vsConstrutivos.begin(), vsConstrutivos.end(), sNome) != vsConstrutivos.end();
+}
+
+sSolucao sExecutarConstrutivo(const string& sNome, const sGrafo& grafo, const vector<vector<int>>& vviDistancias, int iNumThreads) {
+    METRICA_FASE(FASE_CONSTRUTIVO);
+    vector<sServico> vsServicos = extrairServicos(grafo);
+    if (sNome == "savings") {
+        sSolucao solucao = sSavings(vsServicos, vviDistancias, grafo.deposito, grafo.capacidadeVeiculo);
+        cout << "Savings: custo " << solucao.iCustoTotal << " (" << solucao.rotas.size() << " rotas)" << endl;
+        return solucao;
+    }
+    int iRegra = 0;
+    sSolucao solucao = sPathScanningParalelo(vsServicos, vviDistancias, grafo.deposito, grafo.capacidadeVeiculo, iNumThreads, &iRegra);
+    cout << "Path-scanning: custo " << solucao.iCustoTotal << " (regra " << vsNomesRegrasPathScanning[iRegra] << ")" << endl;
+    return solucao;
+}
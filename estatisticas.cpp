@@ -1,15 +1,20 @@
 #include "grafo.hpp"
+#include "rastreamento.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstdint>
+#include <cstdio>
 using namespace std;
 
 double dCalcularDensidade(int iNumVertices, int iNumArestas, int iNumArcos, bool bEhDirecionado) {
+    RASTREAR("dCalcularDensidade");
     if (iNumVertices <= 1) return 0.0;
     return static_cast<double>((2 * iNumArestas) + iNumArcos) / (iNumVertices * (iNumVertices - 1));
 }
 
 void calcularGraus(const sGrafo& sGrafo, int iNumVertices, int& iGrauMinimo, int& iGrauMaximo) {
+    RASTREAR("calcularGraus");
     vector<int> viGraus(iNumVertices + 1, 0);
     for (const sAresta& sAresta : sGrafo.vsArestas) {
         viGraus[sAresta.origem]++;
@@ -35,6 +40,7 @@ void dfsVisitar(int iVertice, const vector<vector<int>>& vviAdjacencias, vector<
 }
 
 int iCalcularComponentesConectados(const sGrafo& sGrafo, int iNumVertices) {
+    RASTREAR("iCalcularComponentesConectados");
     vector<vector<int>> vviAdjacencias(iNumVertices + 1);
     for (const sAresta& sAresta : sGrafo.vsArestas) {
         vviAdjacencias[sAresta.origem].push_back(sAresta.destino);
@@ -56,6 +62,7 @@ int iCalcularComponentesConectados(const sGrafo& sGrafo, int iNumVertices) {
 }
 
 pair<double, int> calcularCaminhoMedioDiametro(const vector<vector<int>>& vviDistancias, int iNumVertices) {
+    RASTREAR("calcularCaminhoMedioDiametro");
     int iTotal = 0, iPares = 0, iDiametro = 0;
     for (int iLinha = 1; iLinha <= iNumVertices; ++iLinha) {
         for (int iColuna = 1; iColuna <= iNumVertices; ++iColuna) {
@@ -71,6 +78,7 @@ pair<double, int> calcularCaminhoMedioDiametro(const vector<vector<int>>& vviDis
 }
 
 vector<int> viCalcularIntermediacoes(const vector<vector<int>>& vviPredecessores, const vector<vector<int>>& vviDistancias, int iNumVertices) {
+    RASTREAR("viCalcularIntermediacoes");
     vector<int> viIntermediacoes(iNumVertices + 1, 0);
     for (int iOrigem = 1; iOrigem <= iNumVertices; ++iOrigem) {
         for (int iDestino = 1; iDestino <= iNumVertices; ++iDestino) {
@@ -163,14 +171,52 @@ void exibirEstatisticasFormatadas(const sGrafo& sGrafo, double dDensidade, int i
     cout << "13. Diametro: " << iDiametro << endl;
 }
 
-void salvarEmArquivo(const sGrafo& grafo, double dDensidade, int iComponentes,
+// Grava as linhas/colunas 1..iNumVertices da matriz em formato .npy (versao
+// 1.0, int32 little-endian, ordem C), que o numpy le com np.load, inclusive
+// mapeado em memoria (mmap_mode='r')
+bool bSalvarMatrizNpy(const string& sCaminho, const vector<vector<int>>& vviMatriz, int iNumVertices) {
+    ofstream arquivo(sCaminho, ios::binary);
+    if (!arquivo.is_open()) {
+        cerr << "Erro ao abrir o arquivo de saída: " << sCaminho << endl;
+        return false;
+    }
+    string sCabecalho = "{'descr': '<i4', 'fortran_order': False, 'shape': (" + to_string(iNumVertices) + ", " +
+                        to_string(iNumVertices) + "), }";
+    // magica (6) + versao (2) + tamanho do cabecalho (2): os dados comecam alinhados a 64 bytes
+    size_t iTotal = 10 + sCabecalho.size() + 1;
+    sCabecalho += string((64 - iTotal % 64) % 64, ' ') + "\n";
+    arquivo.write("\x93NUMPY\x01\x00", 8);
+    unsigned char vcTamanho[2] = {(unsigned char)(sCabecalho.size() & 0xFF), (unsigned char)(sCabecalho.size() >> 8)};
+    arquivo.write((const char*)vcTamanho, 2);
+    arquivo << sCabecalho;
+
+    // bytes montados um a um para independer da ordem de bytes da maquina
+    vector<unsigned char> vcLinha(4 * (size_t)iNumVertices);
+    for (int i = 1; i <= iNumVertices; ++i) {
+        for (int j = 1; j <= iNumVertices; ++j) {
+            uint32_t iValor = (uint32_t)vviMatriz[i][j];
+            for (int b = 0; b < 4; ++b)
+                vcLinha[4 * (j - 1) + b] = (unsigned char)(iValor >> (8 * b));
+        }
+        arquivo.write((const char*)vcLinha.data(), vcLinha.size());
+    }
+    return (bool)arquivo;
+}
+
+// Com bMatrizesNpy, as matrizes de distancias e predecessores vao para
+// arquivos .npy ao lado do JSON (que so guarda o nome deles), em vez de
+// listas aninhadas no proprio JSON. Devolve false se o arquivo nao pode ser aberto
+bool salvarEmArquivo(const sGrafo& grafo, double dDensidade, int iComponentes,
     int iGrauMinimo, int iGrauMaximo, double dCaminhoMedio, int iDiametro,
     const vector<int>& viIntermediacoes, const string& sNomeArquivo, 
-    const vector<vector<int>>& vviDistancias, const vector<vector<int>>& vviPredecessores) {
+    const vector<vector<int>>& vviDistancias, const vector<vector<int>>& vviPredecessores,
+    const sLimitanteInferior& limitante, bool bMatrizesNpy = false) {
+    RASTREAR("salvarEmArquivo");
 
     ofstream arquivoSaida(sNomeArquivo);
     if (!arquivoSaida.is_open()) {
         cerr << "Erro ao abrir o arquivo de saída!" << endl;
+        return false;
     } else {
         // Gera a string JSON do grafo e a ajusta para ser inclusa no JSON final
         string sGrafoString = sGerarGrafoJSON(grafo);
@@ -191,6 +237,11 @@ void salvarEmArquivo(const sGrafo& grafo, double dDensidade, int iComponentes,
         arquivoSaida << "    \"grauMax\": " << iGrauMaximo << ",\n";
         arquivoSaida << "    \"caminhoMedio\": " << dCaminhoMedio << ",\n";
         arquivoSaida << "    \"diametro\": " << iDiametro << ",\n";
+        arquivoSaida << "    \"valorOtimo\": " << grafo.valorOtimo << ",\n";
+        arquivoSaida << "    \"limitanteInferior\": " << limitante.iValor << ",\n";
+        arquivoSaida << "    \"limitanteCustoServicos\": " << limitante.iCustoServicos << ",\n";
+        arquivoSaida << "    \"limitanteDeslocamento\": " << limitante.iDeslocamentoMinimo << ",\n";
+        arquivoSaida << "    \"numVeiculosMinimo\": " << limitante.iNumVeiculosMinimo << ",\n";
         arquivoSaida << "    \"intermediacao\": [";
         for (size_t i = 0; i < viIntermediacoes.size(); ++i) {
             arquivoSaida << viIntermediacoes[i];
@@ -201,50 +252,69 @@ void salvarEmArquivo(const sGrafo& grafo, double dDensidade, int iComponentes,
         
         arquivoSaida << "   },\n";
 
-        // Inserção da Matriz de Distância
-        arquivoSaida << "    \"matrizDistancia\": [\n";
-        for (int i = 1; i <= grafo.iNumVertices; ++i) {
-            arquivoSaida << "      [";
-            for (int j = 1; j <= grafo.iNumVertices; ++j) {
-                if (vviDistancias[i][j] == INF)
-                    arquivoSaida << "\"INF\"";
+        if (bMatrizesNpy) {
+            // Nomes relativos a pasta do JSON
+            string sBase = sNomeArquivo.substr(0, sNomeArquivo.rfind(".json"));
+            string sPasta = sNomeArquivo.substr(0, sNomeArquivo.find_last_of('/') + 1);
+            string sArquivoDistancias = sBase + "_distancias.npy", sArquivoPredecessores = sBase + "_predecessores.npy";
+            // O JSON so referencia os .npy se os dois foram gravados
+            if (!bSalvarMatrizNpy(sArquivoDistancias, vviDistancias, grafo.iNumVertices) ||
+                !bSalvarMatrizNpy(sArquivoPredecessores, vviPredecessores, grafo.iNumVertices)) {
+                cerr << "Erro ao gravar as matrizes .npy de " << sNomeArquivo << endl;
+                arquivoSaida.close();
+                remove(sNomeArquivo.c_str());
+                return false;
+            }
+            arquivoSaida << "    \"matrizDistanciaNpy\": \"" << sArquivoDistancias.substr(sPasta.size()) << "\",\n";
+            arquivoSaida << "    \"matrizPredecessoresNpy\": \"" << sArquivoPredecessores.substr(sPasta.size()) << "\",\n";
+            arquivoSaida << "    \"distanciaInfinita\": " << INF << ",\n";
+            arquivoSaida << "    \"predecessorNulo\": -1,\n";
+        } else {
+            // Inserção da Matriz de Distância
+            arquivoSaida << "    \"matrizDistancia\": [\n";
+            for (int i = 1; i <= grafo.iNumVertices; ++i) {
+                arquivoSaida << "      [";
+                for (int j = 1; j <= grafo.iNumVertices; ++j) {
+                    if (vviDistancias[i][j] == INF)
+                        arquivoSaida << "\"INF\"";
+                    else
+                        arquivoSaida << vviDistancias[i][j];
+                    if (j <= grafo.iNumVertices - 1)
+                        arquivoSaida << ", ";
+                }
+                arquivoSaida << "]";
+                if (i <= grafo.iNumVertices - 1)
+                    arquivoSaida << ",\n";
                 else
-                    arquivoSaida << vviDistancias[i][j];
-                if (j <= grafo.iNumVertices - 1)
-                    arquivoSaida << ", ";
+                    arquivoSaida << "\n";
             }
-            arquivoSaida << "]";
-            if (i <= grafo.iNumVertices - 1)
-                arquivoSaida << ",\n";
-            else
-                arquivoSaida << "\n";
-        }
-        arquivoSaida << "    ],\n";
-
-        // Inserção da Matriz de Predecessores
-        arquivoSaida << "    \"matrizPredecessores\": [\n";
-        for (int i = 1; i <= grafo.iNumVertices; ++i) {
-            arquivoSaida << "      [";
-            for (int j = 1; j <= grafo.iNumVertices; ++j) {
-                if (vviPredecessores[i][j] == -1)
-                    arquivoSaida << "\"NULO\"";
+            arquivoSaida << "    ],\n";
+
+            // Inserção da Matriz de Predecessores
+            arquivoSaida << "    \"matrizPredecessores\": [\n";
+            for (int i = 1; i <= grafo.iNumVertices; ++i) {
+                arquivoSaida << "      [";
+                for (int j = 1; j <= grafo.iNumVertices; ++j) {
+                    if (vviPredecessores[i][j] == -1)
+                        arquivoSaida << "\"NULO\"";
+                    else
+                        arquivoSaida << vviPredecessores[i][j];
+                    if (j <= grafo.iNumVertices - 1)
+                        arquivoSaida << ", ";
+                }
+                arquivoSaida << "]";
+                if (i <= grafo.iNumVertices - 1)
+                    arquivoSaida << ",\n";
                 else
-                    arquivoSaida << vviPredecessores[i][j];
-                if (j <= grafo.iNumVertices - 1)
-                    arquivoSaida << ", ";
+                    arquivoSaida << "\n";
             }
-            arquivoSaida << "]";
-            if (i <= grafo.iNumVertices - 1)
-                arquivoSaida << ",\n";
-            else
-                arquivoSaida << "\n";
+            arquivoSaida << "    ],\n";
         }
-        arquivoSaida << "    ],\n";
 
         arquivoSaida << "  \"grafo_json\": \"" << sJsonAjustado << "\"\n";
         arquivoSaida << "}\n";
 
         arquivoSaida.close();
-        cout << "\nInformacoes salvas em: " << sNomeArquivo << endl;
     }
+    return true;
 }
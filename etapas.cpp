@@ -0,0 +1,109 @@
+#include <vector>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include "rastreamento.hpp"
+
+using namespace std;
+
+// Grafo de dependencias das etapas do processamento de uma instancia. Cada etapa
+// roda em sua propria thread assim que todas as suas dependencias terminam, de
+// modo que etapas independentes (estatisticas e solucao, por exemplo) rodam em
+// paralelo. Uma etapa que falha (retorna false) ou que foi pulada faz com que as
+// etapas que dependem dela tambem sejam puladas. Com bSequencial, as etapas
+// rodam uma de cada vez, na ordem da lista, na thread que chamou (para medir
+// cada fase sem a interferencia das demais).
+
+enum eEstadoEtapa {
+    ETAPA_PENDENTE,
+    ETAPA_CONCLUIDA,
+    ETAPA_FALHOU,
+    ETAPA_PULADA
+};
+
+struct sEtapa {
+    string sNome;
+    vector<int> viDependencias; // indices de etapas anteriores na lista
+    function<bool()> executar;
+    bool bPular = false;
+    eEstadoEtapa estado = ETAPA_PENDENTE;
+};
+
+// Adiciona uma etapa e devolve seu indice, usado como dependencia das seguintes
+int iAdicionarEtapa(vector<sEtapa>& vsEtapas, const string& sNome, vector<int> viDependencias, function<bool()> executar) {
+    sEtapa etapa;
+    etapa.sNome = sNome;
+    etapa.viDependencias = move(viDependencias);
+    etapa.executar = move(executar);
+    vsEtapas.push_back(move(etapa));
+    return (int)vsEtapas.size() - 1;
+}
+
+// Marca como puladas as etapas cujo nome esta em vsPuladas
+void marcarEtapasPuladas(vector<sEtapa>& vsEtapas, const vector<string>& vsPuladas) {
+    for (sEtapa& etapa : vsEtapas)
+        for (const string& sNome : vsPuladas)
+            if (etapa.sNome == sNome)
+                etapa.bPular = true;
+}
+
+void executarEtapas(vector<sEtapa>& vsEtapas, bool bSequencial = false) {
+    mutex mEstado;
+    condition_variable cvEtapaTerminou;
+
+    auto bProntaOuDescartada = [&](const sEtapa& etapa, bool& bDescartar) {
+        bDescartar = false;
+        for (int iDependencia : etapa.viDependencias) {
+            eEstadoEtapa estado = vsEtapas[iDependencia].estado;
+            if (estado == ETAPA_PENDENTE)
+                return false;
+            if (estado != ETAPA_CONCLUIDA)
+                bDescartar = true;
+        }
+        return true;
+    };
+
+    // As dependencias de uma etapa vem antes dela na lista
+    if (bSequencial) {
+        for (sEtapa& etapa : vsEtapas) {
+            bool bDescartar = false;
+            bProntaOuDescartada(etapa, bDescartar);
+            if (bDescartar || etapa.bPular)
+                etapa.estado = ETAPA_PULADA;
+            else
+                etapa.estado = etapa.executar() ? ETAPA_CONCLUIDA : ETAPA_FALHOU;
+        }
+        return;
+    }
+
+    // As etapas herdam a instancia rastreada da thread que as executa
+    int iInstancia = iInstanciaRastreamento();
+    vector<thread> vThreads;
+    for (size_t iEtapa = 0; iEtapa < vsEtapas.size(); ++iEtapa) {
+        vThreads.emplace_back([&, iEtapa]() {
+            definirInstanciaRastreamento(iInstancia);
+            sEtapa& etapa = vsEtapas[iEtapa];
+            bool bDescartar = false;
+            {
+                unique_lock<mutex> trava(mEstado);
+                cvEtapaTerminou.wait(trava, [&]() { return bProntaOuDescartada(etapa, bDescartar); });
+                if (bDescartar || etapa.bPular) {
+                    etapa.estado = ETAPA_PULADA;
+                    cvEtapaTerminou.notify_all();
+                    return;
+                }
+            }
+            bool bSucesso = etapa.executar();
+            {
+                lock_guard<mutex> trava(mEstado);
+                etapa.estado = bSucesso ? ETAPA_CONCLUIDA : ETAPA_FALHOU;
+            }
+            cvEtapaTerminou.notify_all();
+        });
+    }
+    for (auto& th : vThreads)
+        th.join();
+}
@@ -0,0 +1,307 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+using namespace std;
+
+// Gerador de instancias sinteticas grandes no formato lido por sLerArquivo.
+// Gera malhas viarias em grade ou geometricas aleatorias (pontos no quadrado
+// unitario ligados aos vizinhos dentro de um raio). Uma arvore geradora de
+// arestas garante que o grafo seja fortemente conexo; as demais ligacoes viram
+// arcos (mao unica) com a probabilidade informada.
+//
+// Uso: gerador [opcoes]
+//   --tipo grade|geometrico           topologia da malha (padrao: grade)
+//   --vertices N                      numero de vertices (padrao: 10000)
+//   --fracao-arcos F                  fracao das ligacoes que viram arcos (padrao: 0.3)
+//   --fracao-requeridos R             fracao das ligacoes com servico (padrao: 0.3)
+//   --fracao-vertices-requeridos V    fracao dos vertices com servico (padrao: 0.05)
+//   --demanda uniforme|exponencial    distribuicao da demanda (padrao: uniforme)
+//   --demanda-min A --demanda-max B   intervalo da demanda uniforme (padrao: 1 a 10)
+//   --demanda-media M                 media da demanda exponencial (padrao: 5)
+//   --capacidade C                    capacidade dos veiculos (padrao: ~40 servicos por rota)
+//   --semente S                       semente do gerador aleatorio (padrao: 1)
+//   --nome NOME                       nome da instancia (padrao: derivado dos parametros)
+//   --saida DIRETORIO                 diretorio de saida (padrao: ./instancias/)
+
+const int CUSTO_BASE_LIGACAO = 10; // custo de transito de uma ligacao de comprimento unitario da grade
+const int SERVICOS_POR_ROTA_PADRAO = 40;
+
+struct sParametrosGerador {
+    string sTipo = "grade";
+    int iNumVertices = 10000;
+    double dFracaoArcos = 0.3;
+    double dFracaoRequeridos = 0.3;
+    double dFracaoVerticesRequeridos = 0.05;
+    string sDistribuicaoDemanda = "uniforme";
+    int iDemandaMinima = 1;
+    int iDemandaMaxima = 10;
+    double dDemandaMedia = 5.0;
+    int iCapacidade = 0; // 0: calculada a partir da demanda media
+    unsigned int iSemente = 1;
+    string sNome;
+    string sDiretorioSaida = "./instancias/";
+};
+
+struct sLigacao {
+    int iOrigem, iDestino;
+    int iCustoTransito;
+    bool bArco = false;
+    bool bRequerida = false;
+    int iDemanda = 0;
+};
+
+// Union-find com compressao de caminho, usado para a arvore geradora
+struct sConjuntosDisjuntos {
+    vector<int> viPai;
+
+    explicit sConjuntosDisjuntos(int iTamanho) : viPai(iTamanho) {
+        iota(viPai.begin(), viPai.end(), 0);
+    }
+    int iRaiz(int x) {
+        while (viPai[x] != x) {
+            viPai[x] = viPai[viPai[x]];
+            x = viPai[x];
+        }
+        return x;
+    }
+    bool bUnir(int a, int b) {
+        a = iRaiz(a);
+        b = iRaiz(b);
+        if (a == b) return false;
+        viPai[a] = b;
+        return true;
+    }
+};
+
+// Grade lado x lado (4-vizinhanca) com custos perturbados em +-20%
+vector<sLigacao> vsGerarGrade(int iNumVertices, mt19937& gerador, int& iDeposito) {
+    int iLado = max(2, (int)ceil(sqrt((double)iNumVertices)));
+    uniform_real_distribution<double> perturbacao(0.8, 1.2);
+    vector<sLigacao> vsLigacoes;
+    auto iIndice = [&](int iLinha, int iColuna) { return iLinha * iLado + iColuna + 1; };
+    for (int iLinha = 0; iLinha < iLado; ++iLinha) {
+        for (int iColuna = 0; iColuna < iLado; ++iColuna) {
+            if (iIndice(iLinha, iColuna) > iNumVertices) continue;
+            if (iColuna + 1 < iLado && iIndice(iLinha, iColuna + 1) <= iNumVertices)
+                vsLigacoes.push_back({iIndice(iLinha, iColuna), iIndice(iLinha, iColuna + 1),
+                                      max(1, (int)lround(CUSTO_BASE_LIGACAO * perturbacao(gerador)))});
+            if (iLinha + 1 < iLado && iIndice(iLinha + 1, iColuna) <= iNumVertices)
+                vsLigacoes.push_back({iIndice(iLinha, iColuna), iIndice(iLinha + 1, iColuna),
+                                      max(1, (int)lround(CUSTO_BASE_LIGACAO * perturbacao(gerador)))});
+        }
+    }
+    iDeposito = min(iNumVertices, iIndice(iLado / 2, iLado / 2));
+    return vsLigacoes;
+}
+
+// Grafo geometrico aleatorio: liga pares a distancia menor que o raio, com
+// grade de baldes para evitar a comparacao de todos os pares
+vector<sLigacao> vsGerarGeometrico(int iNumVertices, mt19937& gerador, int& iDeposito) {
+    uniform_real_distribution<double> coordenada(0.0, 1.0);
+    vector<double> vdX(iNumVertices + 1), vdY(iNumVertices + 1);
+    for (int v = 1; v <= iNumVertices; ++v) {
+        vdX[v] = coordenada(gerador);
+        vdY[v] = coordenada(gerador);
+    }
+    // grau medio em torno de 6
+    double dRaio = sqrt(6.0 / (M_PI * iNumVertices));
+    double dEscala = CUSTO_BASE_LIGACAO * sqrt((double)iNumVertices); // comprimento unitario da grade equivalente
+    int iBaldesPorLado = max(1, (int)(1.0 / dRaio));
+    vector<vector<int>> vviBaldes(iBaldesPorLado * iBaldesPorLado);
+    auto iBalde = [&](double d) { return min(iBaldesPorLado - 1, (int)(d * iBaldesPorLado)); };
+    for (int v = 1; v <= iNumVertices; ++v)
+        vviBaldes[iBalde(vdY[v]) * iBaldesPorLado + iBalde(vdX[v])].push_back(v);
+
+    auto iCusto = [&](int a, int b) {
+        return max(1, (int)lround(hypot(vdX[a] - vdX[b], vdY[a] - vdY[b]) * dEscala));
+    };
+    vector<sLigacao> vsLigacoes;
+    for (int v = 1; v <= iNumVertices; ++v) {
+        int bx = iBalde(vdX[v]), by = iBalde(vdY[v]);
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int nx = bx + dx, ny = by + dy;
+                if (nx < 0 || ny < 0 || nx >= iBaldesPorLado || ny >= iBaldesPorLado) continue;
+                for (int u : vviBaldes[ny * iBaldesPorLado + nx])
+                    if (u > v && hypot(vdX[u] - vdX[v], vdY[u] - vdY[v]) < dRaio)
+                        vsLigacoes.push_back({v, u, iCusto(v, u)});
+            }
+        }
+    }
+
+    // Componentes isolados sao ligados ao vertice mais proximo ja conectado
+    // ao componente do vertice 1, percorrendo os vertices por coordenada x
+    sConjuntosDisjuntos conjuntos(iNumVertices + 1);
+    for (const sLigacao& ligacao : vsLigacoes)
+        conjuntos.bUnir(ligacao.iOrigem, ligacao.iDestino);
+    vector<int> viOrdem(iNumVertices);
+    iota(viOrdem.begin(), viOrdem.end(), 1);
+    sort(viOrdem.begin(), viOrdem.end(), [&](int a, int b) { return vdX[a] < vdX[b]; });
+    for (size_t k = 1; k < viOrdem.size(); ++k)
+        if (conjuntos.bUnir(viOrdem[k - 1], viOrdem[k]))
+            vsLigacoes.push_back({viOrdem[k - 1], viOrdem[k], iCusto(viOrdem[k - 1], viOrdem[k])});
+
+    // deposito: vertice mais proximo do centro
+    iDeposito = 1;
+    for (int v = 2; v <= iNumVertices; ++v)
+        if (hypot(vdX[v] - 0.5, vdY[v] - 0.5) < hypot(vdX[iDeposito] - 0.5, vdY[iDeposito] - 0.5))
+            iDeposito = v;
+    return vsLigacoes;
+}
+
+int main(int iQtdArgumentos, char* vsArgumentos[]) {
+    sParametrosGerador parametros;
+    for (int iArgumento = 1; iArgumento < iQtdArgumentos; ++iArgumento) {
+        string sArgumento = vsArgumentos[iArgumento];
+        if (iArgumento + 1 >= iQtdArgumentos) {
+            cerr << "Opcao sem valor: " << sArgumento << endl;
+            return 1;
+        }
+        string sValor = vsArgumentos[++iArgumento];
+        if (sArgumento == "--tipo") parametros.sTipo = sValor;
+        else if (sArgumento == "--vertices") parametros.iNumVertices = stoi(sValor);
+        else if (sArgumento == "--fracao-arcos") parametros.dFracaoArcos = stod(sValor);
+        else if (sArgumento == "--fracao-requeridos") parametros.dFracaoRequeridos = stod(sValor);
+        else if (sArgumento == "--fracao-vertices-requeridos") parametros.dFracaoVerticesRequeridos = stod(sValor);
+        else if (sArgumento == "--demanda") parametros.sDistribuicaoDemanda = sValor;
+        else if (sArgumento == "--demanda-min") parametros.iDemandaMinima = stoi(sValor);
+        else if (sArgumento == "--demanda-max") parametros.iDemandaMaxima = stoi(sValor);
+        else if (sArgumento == "--demanda-media") parametros.dDemandaMedia = stod(sValor);
+        else if (sArgumento == "--capacidade") parametros.iCapacidade = stoi(sValor);
+        else if (sArgumento == "--semente") parametros.iSemente = (unsigned int)stoul(sValor);
+        else if (sArgumento == "--nome") parametros.sNome = sValor;
+        else if (sArgumento == "--saida") parametros.sDiretorioSaida = sValor;
+        else {
+            cerr << "Opcao desconhecida: " << sArgumento << endl;
+            return 1;
+        }
+    }
+    if (parametros.sTipo != "grade" && parametros.sTipo != "geometrico") {
+        cerr << "Tipo desconhecido: " << parametros.sTipo << endl;
+        return 1;
+    }
+    if (parametros.iNumVertices < 2 || parametros.iDemandaMinima < 1 || parametros.iDemandaMaxima < parametros.iDemandaMinima) {
+        cerr << "Parametros invalidos" << endl;
+        return 1;
+    }
+    if (parametros.sNome.empty())
+        parametros.sNome = "SINT-" + parametros.sTipo + "-n" + to_string(parametros.iNumVertices) +
+                           "-s" + to_string(parametros.iSemente);
+
+    mt19937 gerador(parametros.iSemente);
+    int iDeposito = 1;
+    vector<sLigacao> vsLigacoes = parametros.sTipo == "grade"
+        ? vsGerarGrade(parametros.iNumVertices, gerador, iDeposito)
+        : vsGerarGeometrico(parametros.iNumVertices, gerador, iDeposito);
+
+    // Ligacoes da arvore geradora (em ordem aleatoria) permanecem arestas
+    vector<int> viOrdem(vsLigacoes.size());
+    iota(viOrdem.begin(), viOrdem.end(), 0);
+    shuffle(viOrdem.begin(), viOrdem.end(), gerador);
+    sConjuntosDisjuntos conjuntos(parametros.iNumVertices + 1);
+    uniform_real_distribution<double> sorteio(0.0, 1.0);
+    for (int iLigacao : viOrdem) {
+        sLigacao& ligacao = vsLigacoes[iLigacao];
+        bool bNaArvore = conjuntos.bUnir(ligacao.iOrigem, ligacao.iDestino);
+        if (!bNaArvore && sorteio(gerador) < parametros.dFracaoArcos) {
+            ligacao.bArco = true;
+            if (sorteio(gerador) < 0.5)
+                swap(ligacao.iOrigem, ligacao.iDestino);
+        }
+    }
+
+    uniform_int_distribution<int> demandaUniforme(parametros.iDemandaMinima, parametros.iDemandaMaxima);
+    exponential_distribution<double> demandaExponencial(1.0 / parametros.dDemandaMedia);
+    bool bExponencial = parametros.sDistribuicaoDemanda == "exponencial";
+    auto iSortearDemanda = [&]() {
+        return bExponencial ? max(1, (int)lround(demandaExponencial(gerador))) : demandaUniforme(gerador);
+    };
+
+    long long lDemandaTotal = 0;
+    int iNumServicos = 0, iMaiorDemanda = 0;
+    for (sLigacao& ligacao : vsLigacoes) {
+        if (sorteio(gerador) < parametros.dFracaoRequeridos) {
+            ligacao.bRequerida = true;
+            ligacao.iDemanda = iSortearDemanda();
+            lDemandaTotal += ligacao.iDemanda;
+            iMaiorDemanda = max(iMaiorDemanda, ligacao.iDemanda);
+            ++iNumServicos;
+        }
+    }
+    vector<int> viDemandaVertice(parametros.iNumVertices + 1, 0);
+    for (int v = 1; v <= parametros.iNumVertices; ++v) {
+        if (v != iDeposito && sorteio(gerador) < parametros.dFracaoVerticesRequeridos) {
+            viDemandaVertice[v] = iSortearDemanda();
+            lDemandaTotal += viDemandaVertice[v];
+            iMaiorDemanda = max(iMaiorDemanda, viDemandaVertice[v]);
+            ++iNumServicos;
+        }
+    }
+    if (parametros.iCapacidade <= 0) {
+        double dDemandaMedia = iNumServicos > 0 ? (double)lDemandaTotal / iNumServicos : 1.0;
+        parametros.iCapacidade = (int)ceil(dDemandaMedia * SERVICOS_POR_ROTA_PADRAO);
+    }
+    parametros.iCapacidade = max(parametros.iCapacidade, iMaiorDemanda);
+
+    // Contagens do cabecalho: #Edges e #Arcs incluem as ligacoes nao requeridas
+    int iNumArestas = 0, iNumArcos = 0, iArestasRequeridas = 0, iArcosRequeridos = 0, iVerticesRequeridos = 0;
+    for (const sLigacao& ligacao : vsLigacoes) {
+        (ligacao.bArco ? iNumArcos : iNumArestas)++;
+        if (ligacao.bRequerida) (ligacao.bArco ? iArcosRequeridos : iArestasRequeridas)++;
+    }
+    for (int v = 1; v <= parametros.iNumVertices; ++v)
+        if (viDemandaVertice[v] > 0) ++iVerticesRequeridos;
+
+    string sCaminho = parametros.sDiretorioSaida + parametros.sNome + ".dat";
+    ofstream arquivo(sCaminho);
+    if (!arquivo.is_open()) {
+        cerr << "Erro ao criar o arquivo " << sCaminho << endl;
+        return 1;
+    }
+    arquivo << "Name:\t\t" << parametros.sNome << "\n";
+    arquivo << "Optimal value:\t-1\n";
+    arquivo << "#Vehicles:\t-1\n";
+    arquivo << "Capacity:\t" << parametros.iCapacidade << "\n";
+    arquivo << "Depot Node:\t" << iDeposito << "\n";
+    arquivo << "#Nodes:\t\t" << parametros.iNumVertices << "\n";
+    arquivo << "#Edges:\t\t" << iNumArestas << "\n";
+    arquivo << "#Arcs:\t\t" << iNumArcos << "\n";
+    arquivo << "#Required N:\t" << iVerticesRequeridos << "\n";
+    arquivo << "#Required E:\t" << iArestasRequeridas << "\n";
+    arquivo << "#Required A:\t" << iArcosRequeridos << "\n";
+
+    arquivo << "\nReN.\tDEMAND\tS. COST\n";
+    for (int v = 1; v <= parametros.iNumVertices; ++v)
+        if (viDemandaVertice[v] > 0)
+            arquivo << "N" << v << "\t" << viDemandaVertice[v] << "\t" << viDemandaVertice[v] << "\n";
+
+    // Custo de atendimento de uma ligacao = custo de transito (percorre-la atendendo)
+    auto escreverSecao = [&](const string& sCabecalho, const string& sPrefixo, bool bArco, bool bRequerida) {
+        arquivo << "\n" << sCabecalho << "\n";
+        int iId = 0;
+        for (const sLigacao& ligacao : vsLigacoes) {
+            if (ligacao.bArco != bArco || ligacao.bRequerida != bRequerida) continue;
+            arquivo << sPrefixo << ++iId << "\t" << ligacao.iOrigem << "\t" << ligacao.iDestino << "\t" << ligacao.iCustoTransito;
+            if (bRequerida)
+                arquivo << "\t" << ligacao.iDemanda << "\t" << ligacao.iCustoTransito;
+            arquivo << "\n";
+        }
+    };
+    escreverSecao("ReE.\tFrom N.\tTo N.\tT. COST\tDEMAND\tS. COST", "E", false, true);
+    escreverSecao("EDGE\tFROM N.\tTO N.\tT. COST", "NrE", false, false);
+    escreverSecao("ReA.\tFROM N.\tTO N.\tT. COST\tDEMAND\tS. COST", "A", true, true);
+    escreverSecao("ARC\tFROM N.\tTO N.\tT. COST", "NrA", true, false);
+    arquivo.close();
+
+    cout << "Instancia " << sCaminho << ": " << parametros.iNumVertices << " vertices, "
+         << iNumArestas << " arestas, " << iNumArcos << " arcos, " << iNumServicos << " servicos, capacidade "
+         << parametros.iCapacidade << endl;
+    return 0;
+}
@@ -77,6 +77,14 @@ struct sGrafo {
     }
 };
 
+// Limitante inferior do custo de qualquer solucao da instancia
+struct sLimitanteInferior {
+    int iCustoServicos = 0;       // soma dos custos de atendimento obrigatorios
+    int iDeslocamentoMinimo = 0;  // limitante do deslocamento sem atendimento (deadheading)
+    int iNumVeiculosMinimo = 0;   // teto(demanda total / capacidade)
+    int iValor = 0;               // iCustoServicos + iDeslocamentoMinimo
+};
+
 // Funcoes utilitarias
 int extrairValorInteiro(const string& linha);
 double dCalcularDensidade(int V, int E, int A, bool ehDirecionado);
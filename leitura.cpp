@@ -1,4 +1,5 @@
 #include "grafo.hpp"
+#include "rastreamento.hpp"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -27,25 +28,22 @@ int iExtrairValorInteiro(const string& sLinha, const string& sChave) {
     }
 }
 
-sGrafo sLerArquivo(const string& sNomeArquivo, bool& bConseguiuLerArquivo) {
+// Le uma instancia no formato .dat de qualquer fluxo (arquivo ou memoria).
+// sNomeArquivo e usado apenas nas mensagens.
+sGrafo sLerGrafo(istream& arquivo, const string& sNomeArquivo, bool& bConseguiuLerArquivo, bool bExibirDepuracao = true) {
     bConseguiuLerArquivo = false; // Inicializa como falso
     sGrafo sGrafoLido;
-    cout << "DEBUG: Tentando abrir arquivo: " << sNomeArquivo << endl;
-    ifstream arquivo("./instancias/" + sNomeArquivo);
-
-    if (!arquivo.is_open()) {
-        cerr << "DEBUG: Falha ao abrir o arquivo: " << sNomeArquivo << endl;
-        return sGrafoLido; // Retorna grafo vazio, bConseguiuLerArquivo continua false
-    }
-    cout << "DEBUG: Arquivo aberto com sucesso: " << sNomeArquivo << endl;
+    // Sem depuracao, as mensagens vao para um fluxo sem buffer (descartadas)
+    ostream saidaNula(nullptr);
+    ostream& saidaDepuracao = bExibirDepuracao ? cout : saidaNula;
 
     string sLinha;
     try {
         // Leitura do cabeçalho
-        cout << "DEBUG: Lendo cabecalho..." << endl;
+        saidaDepuracao << "DEBUG: Lendo cabecalho..." << endl;
         getline(arquivo, sLinha); sGrafoLido.nome = sLinha.substr(sLinha.find(":") + 1);
         sGrafoLido.nome = sGrafoLido.nome.substr(sGrafoLido.nome.find_first_not_of(" \t")); // Remover espaços iniciais
-        cout << "DEBUG: Nome: " << sGrafoLido.nome << endl;
+        saidaDepuracao << "DEBUG: Nome: " << sGrafoLido.nome << endl;
 
         getline(arquivo, sLinha); sGrafoLido.valorOtimo = iExtrairValorInteiro(sLinha, "VALOR OTIMO");
         getline(arquivo, sLinha); sGrafoLido.numVeiculos = iExtrairValorInteiro(sLinha, "NUMERO DE VEICULOS");
@@ -57,16 +55,16 @@ sGrafo sLerArquivo(const string& sNomeArquivo, bool& bConseguiuLerArquivo) {
         getline(arquivo, sLinha); sGrafoLido.numVerticesRequeridos = iExtrairValorInteiro(sLinha, "NUMERO DE VERTICES REQUERIDOS");
         getline(arquivo, sLinha); sGrafoLido.numArestasRequeridas = iExtrairValorInteiro(sLinha, "NUMERO DE ARESTAS REQUERIDAS");
         getline(arquivo, sLinha); sGrafoLido.numArcosRequeridos = iExtrairValorInteiro(sLinha, "NUMERO DE ARCOS REQUERIDOS");
-        cout << "DEBUG: Cabecalho lido. Vertices: " << sGrafoLido.iNumVertices << " DEPOSITO: " << sGrafoLido.deposito << endl;
+        saidaDepuracao << "DEBUG: Cabecalho lido. Vertices: " << sGrafoLido.iNumVertices << " DEPOSITO: " << sGrafoLido.deposito << endl;
 
         // Pular linhas de seção
         getline(arquivo, sLinha); // VERTICES REQUERIDOS
-        cout << "DEBUG: Secao: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Secao: " << sLinha << endl;
         getline(arquivo, sLinha); // (id demanda custo)
-        cout << "DEBUG: Cabecalho secao: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Cabecalho secao: " << sLinha << endl;
 
         // Ler vértices requeridos
-        cout << "DEBUG: Lendo vertices requeridos..." << endl;
+        saidaDepuracao << "DEBUG: Lendo vertices requeridos..." << endl;
         while (getline(arquivo, sLinha) && !sLinha.empty() && sLinha.find("ARESTAS REQUERIDAS") == string::npos) {
             stringstream ss(sLinha);
             string sIdTexto; int iDemanda, iCusto;
@@ -74,14 +72,14 @@ sGrafo sLerArquivo(const string& sNomeArquivo, bool& bConseguiuLerArquivo) {
             if (sIdTexto.empty() || sIdTexto[0] != 'N') continue; // Ignora linhas vazias ou mal formatadas
             int iId = stoi(sIdTexto.substr(1));
             sGrafoLido.vsVertices.push_back({iId, true, iDemanda, iCusto});
-            cout << "DEBUG: Vertice Requerido Lido: ID=" << iId << ", Dem=" << iDemanda << ", Custo=" << iCusto << endl;
+            saidaDepuracao << "DEBUG: Vertice Requerido Lido: ID=" << iId << ", Dem=" << iDemanda << ", Custo=" << iCusto << endl;
         }
-        cout << "DEBUG: Terminou de ler vertices requeridos. Linha atual: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Terminou de ler vertices requeridos. Linha atual: " << sLinha << endl;
 
         // Ler arestas requeridas
-        cout << "DEBUG: Lendo arestas requeridas..." << endl;
+        saidaDepuracao << "DEBUG: Lendo arestas requeridas..." << endl;
         getline(arquivo, sLinha); // (id orig dest custo_transito demanda custo_atendimento)
-        cout << "DEBUG: Cabecalho secao: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Cabecalho secao: " << sLinha << endl;
         while (getline(arquivo, sLinha) && !sLinha.empty() && sLinha.find("ARESTAS NAO REQUERIDAS") == string::npos) {
             stringstream ss(sLinha);
             string sIdTexto;
@@ -89,14 +87,14 @@ sGrafo sLerArquivo(const string& sNomeArquivo, bool& bConseguiuLerArquivo) {
             ss >> sIdTexto >> iOrigem >> iDestino >> iCustoTransito >> iDemanda >> iCustoAtendimento;
             if (sIdTexto.empty() || sIdTexto[0] != 'E') continue;
             sGrafoLido.vsArestas.push_back({stoi(sIdTexto.substr(1)), iOrigem, iDestino, iCustoTransito, iDemanda, iCustoAtendimento, true});
-            cout << "DEBUG: Aresta Requerida Lida: ID=" << sIdTexto.substr(1) << endl;
+            saidaDepuracao << "DEBUG: Aresta Requerida Lida: ID=" << sIdTexto.substr(1) << endl;
         }
-        cout << "DEBUG: Terminou de ler arestas requeridas. Linha atual: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Terminou de ler arestas requeridas. Linha atual: " << sLinha << endl;
 
         // Ler arestas não requeridas
-        cout << "DEBUG: Lendo arestas nao requeridas..." << endl;
+        saidaDepuracao << "DEBUG: Lendo arestas nao requeridas..." << endl;
         getline(arquivo, sLinha); // (id orig dest custo_transito)
-        cout << "DEBUG: Cabecalho secao: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Cabecalho secao: " << sLinha << endl;
         while (getline(arquivo, sLinha) && !sLinha.empty() && sLinha.find("ARCOS REQUERIDOS") == string::npos) {
             stringstream ss(sLinha);
             string sIdTexto;
@@ -104,14 +102,14 @@ sGrafo sLerArquivo(const string& sNomeArquivo, bool& bConseguiuLerArquivo) {
             ss >> sIdTexto >> iOrigem >> iDestino >> iCustoTransito;
             if (sIdTexto.empty() || sIdTexto.substr(0, 3) != "NrE") continue;
             sGrafoLido.vsArestas.push_back({stoi(sIdTexto.substr(3)), iOrigem, iDestino, iCustoTransito, 0, 0, false});
-            cout << "DEBUG: Aresta Nao Requerida Lida: ID=" << sIdTexto.substr(3) << endl;
+            saidaDepuracao << "DEBUG: Aresta Nao Requerida Lida: ID=" << sIdTexto.substr(3) << endl;
         }
-        cout << "DEBUG: Terminou de ler arestas nao requeridas. Linha atual: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Terminou de ler arestas nao requeridas. Linha atual: " << sLinha << endl;
 
         // Ler arcos requeridos
-        cout << "DEBUG: Lendo arcos requeridos..." << endl;
+        saidaDepuracao << "DEBUG: Lendo arcos requeridos..." << endl;
         getline(arquivo, sLinha); // (id orig dest custo_transito demanda custo_atendimento)
-        cout << "DEBUG: Cabecalho secao: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Cabecalho secao: " << sLinha << endl;
         while (getline(arquivo, sLinha) && !sLinha.empty() && sLinha.find("ARCOS NAO REQUERIDOS") == string::npos) {
             stringstream ss(sLinha);
             string sIdTexto;
@@ -119,14 +117,14 @@ sGrafo sLerArquivo(const string& sNomeArquivo, bool& bConseguiuLerArquivo) {
             ss >> sIdTexto >> iOrigem >> iDestino >> iCustoTransito >> iDemanda >> iCustoAtendimento;
             if (sIdTexto.empty() || sIdTexto[0] != 'A') continue;
             sGrafoLido.vsArcos.push_back({stoi(sIdTexto.substr(1)), iOrigem, iDestino, iCustoTransito, iDemanda, iCustoAtendimento, true});
-            cout << "DEBUG: Arco Requerido Lido: ID=" << sIdTexto.substr(1) << endl;
+            saidaDepuracao << "DEBUG: Arco Requerido Lido: ID=" << sIdTexto.substr(1) << endl;
         }
-        cout << "DEBUG: Terminou de ler arcos requeridos. Linha atual: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Terminou de ler arcos requeridos. Linha atual: " << sLinha << endl;
 
         // Ler arcos não requeridos
-        cout << "DEBUG: Lendo arcos nao requeridos..." << endl;
+        saidaDepuracao << "DEBUG: Lendo arcos nao requeridos..." << endl;
         getline(arquivo, sLinha); // (id orig dest custo_transito)
-        cout << "DEBUG: Cabecalho secao: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Cabecalho secao: " << sLinha << endl;
         while (getline(arquivo, sLinha) && !sLinha.empty() && sLinha.find("FIM") == string::npos) { // Ler até FIM
             stringstream ss(sLinha);
             string sIdTexto;
@@ -134,20 +132,35 @@ sGrafo sLerArquivo(const string& sNomeArquivo, bool& bConseguiuLerArquivo) {
             ss >> sIdTexto >> iOrigem >> iDestino >> iCustoTransito;
             if (sIdTexto.empty() || sIdTexto.substr(0, 3) != "NrA") continue;
             sGrafoLido.vsArcos.push_back({stoi(sIdTexto.substr(3)), iOrigem, iDestino, iCustoTransito, 0, 0, false});
-            cout << "DEBUG: Arco Nao Requerido Lido: ID=" << sIdTexto.substr(3) << endl;
+            saidaDepuracao << "DEBUG: Arco Nao Requerido Lido: ID=" << sIdTexto.substr(3) << endl;
         }
-        cout << "DEBUG: Terminou de ler arcos nao requeridos. Linha atual: " << sLinha << endl;
+        saidaDepuracao << "DEBUG: Terminou de ler arcos nao requeridos. Linha atual: " << sLinha << endl;
 
         // Se chegou até aqui sem exceções, a leitura foi bem-sucedida
         bConseguiuLerArquivo = true;
-        cout << "DEBUG: Leitura concluida com sucesso para " << sNomeArquivo << endl;
+        saidaDepuracao << "DEBUG: Leitura concluida com sucesso para " << sNomeArquivo << endl;
 
     } catch (const std::exception& e) {
         cerr << "DEBUG: Excecao durante a leitura do arquivo " << sNomeArquivo << ": " << e.what() << endl;
         bConseguiuLerArquivo = false;
     }
 
-    arquivo.close();
     return sGrafoLido;
 }
 
+sGrafo sLerArquivo(const string& sNomeArquivo, bool& bConseguiuLerArquivo, bool bExibirDepuracao = true) {
+    RASTREAR("sLerArquivo");
+    bConseguiuLerArquivo = false;
+    if (bExibirDepuracao)
+        cout << "DEBUG: Tentando abrir arquivo: " << sNomeArquivo << endl;
+    ifstream arquivo("./instancias/" + sNomeArquivo);
+
+    if (!arquivo.is_open()) {
+        cerr << "DEBUG: Falha ao abrir o arquivo: " << sNomeArquivo << endl;
+        return sGrafo(); // Retorna grafo vazio, bConseguiuLerArquivo continua false
+    }
+    if (bExibirDepuracao)
+        cout << "DEBUG: Arquivo aberto com sucesso: " << sNomeArquivo << endl;
+    return sLerGrafo(arquivo, sNomeArquivo, bConseguiuLerArquivo, bExibirDepuracao);
+}
+
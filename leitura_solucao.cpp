@@ -0,0 +1,196 @@
+#include "grafo.hpp"
+#include "solucao.hpp"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+using namespace std;
+
+// Leitura dos arquivos sol-*.dat gravados por salvarSolucaoDat
+
+// Uma tripla (D ...) ou (S id,extremidade1,extremidade2) de uma rota
+struct sVisitaLida {
+    char cTipo;
+    int iId;
+    int iVertice1;
+    int iVertice2;
+};
+
+struct sRotaLida {
+    int iDeposito;
+    int iDia;
+    int iId;
+    int iDemanda;
+    int iCusto;
+    int iVisitas;
+    vector<sVisitaLida> vsVisitas;
+};
+
+struct sSolucaoLida {
+    long lCustoTotal = 0;
+    int iNumRotas = 0;
+    long lClockExecucao = 0;
+    long lClockParaAcharSolucao = 0;
+    vector<sRotaLida> vsRotas;
+};
+
+// Percorre o texto sem criar substrings (o validador le centenas de arquivos)
+struct sCursorTexto {
+    const string& sTexto;
+    size_t iPosicao = 0;
+
+    explicit sCursorTexto(const string& sEntrada) : sTexto(sEntrada) {}
+
+    void pularEspacos() {
+        while (iPosicao < sTexto.size() && isspace((unsigned char)sTexto[iPosicao]) && sTexto[iPosicao] != '\n')
+            iPosicao++;
+    }
+
+    bool bFimLinha() {
+        pularEspacos();
+        return iPosicao >= sTexto.size() || sTexto[iPosicao] == '\n';
+    }
+
+    bool bLerInteiro(long& lValor) {
+        pularEspacos();
+        size_t iInicio = iPosicao;
+        bool bNegativo = false;
+        if (iPosicao < sTexto.size() && sTexto[iPosicao] == '-') { bNegativo = true; iPosicao++; }
+        lValor = 0;
+        while (iPosicao < sTexto.size() && isdigit((unsigned char)sTexto[iPosicao]))
+            lValor = lValor * 10 + (sTexto[iPosicao++] - '0');
+        if (bNegativo) lValor = -lValor;
+        return iPosicao > iInicio + (bNegativo ? 1 : 0);
+    }
+
+    bool bLerInteiro(int& iValor) {
+        long lValor;
+        bool bOk = bLerInteiro(lValor);
+        iValor = (int)lValor;
+        return bOk;
+    }
+
+    bool bConsumir(char c) {
+        pularEspacos();
+        if (iPosicao < sTexto.size() && sTexto[iPosicao] == c) { iPosicao++; return true; }
+        return false;
+    }
+
+    void proximaLinha() {
+        while (iPosicao < sTexto.size() && sTexto[iPosicao] != '\n') iPosicao++;
+        if (iPosicao < sTexto.size()) iPosicao++;
+    }
+
+    bool bFim() {
+        while (iPosicao < sTexto.size() && isspace((unsigned char)sTexto[iPosicao])) iPosicao++;
+        return iPosicao >= sTexto.size();
+    }
+};
+
+// Interpreta o conteudo de um arquivo de solucao. Em caso de erro, preenche sErro.
+bool bInterpretarSolucao(const string& sConteudo, sSolucaoLida& solucao, string& sErro) {
+    sCursorTexto cursor(sConteudo);
+    if (!cursor.bLerInteiro(solucao.lCustoTotal)) { sErro = "custo total ausente"; return false; }
+    cursor.proximaLinha();
+    if (!cursor.bLerInteiro(solucao.iNumRotas)) { sErro = "quantidade de rotas ausente"; return false; }
+    cursor.proximaLinha();
+    if (!cursor.bLerInteiro(solucao.lClockExecucao)) { sErro = "clocks de execucao ausentes"; return false; }
+    cursor.proximaLinha();
+    if (!cursor.bLerInteiro(solucao.lClockParaAcharSolucao)) { sErro = "clocks ate a solucao ausentes"; return false; }
+    cursor.proximaLinha();
+
+    while (!cursor.bFim()) {
+        sRotaLida rota;
+        if (!cursor.bLerInteiro(rota.iDeposito) || !cursor.bLerInteiro(rota.iDia) || !cursor.bLerInteiro(rota.iId) ||
+            !cursor.bLerInteiro(rota.iDemanda) || !cursor.bLerInteiro(rota.iCusto) || !cursor.bLerInteiro(rota.iVisitas)) {
+            sErro = "cabecalho de rota invalido na rota " + to_string(solucao.vsRotas.size() + 1);
+            return false;
+        }
+        while (!cursor.bFimLinha()) {
+            sVisitaLida visita;
+            if (!cursor.bConsumir('(')) { sErro = "tripla mal formada na rota " + to_string(rota.iId); return false; }
+            cursor.pularEspacos();
+            visita.cTipo = cursor.iPosicao < sConteudo.size() ? sConteudo[cursor.iPosicao++] : '?';
+            if ((visita.cTipo != 'D' && visita.cTipo != 'S') ||
+                !cursor.bLerInteiro(visita.iId) || !cursor.bConsumir(',') ||
+                !cursor.bLerInteiro(visita.iVertice1) || !cursor.bConsumir(',') ||
+                !cursor.bLerInteiro(visita.iVertice2) || !cursor.bConsumir(')')) {
+                sErro = "tripla mal formada na rota " + to_string(rota.iId);
+                return false;
+            }
+            rota.vsVisitas.push_back(visita);
+        }
+        cursor.proximaLinha();
+        solucao.vsRotas.push_back(rota);
+    }
+    return true;
+}
+
+bool bLerSolucaoDat(const string& sCaminhoArquivo, sSolucaoLida& solucao, string& sErro) {
+    ifstream arquivo(sCaminhoArquivo, ios::binary);
+    if (!arquivo.is_open()) {
+        sErro = "nao foi possivel abrir " + sCaminhoArquivo;
+        return false;
+    }
+    stringstream ss;
+    ss << arquivo.rdbuf();
+    return bInterpretarSolucao(ss.str(), solucao, sErro);
+}
+
+// Reconstroi uma sSolucao a partir de uma solucao lida, usando a lista de
+// servicos da instancia (extrairServicos) e recalculando demandas e custos.
+// Falha se algum servico nao existir, se repetir, faltar ou exceder a capacidade.
+bool bConverterSolucaoLida(
+							const sSolucaoLida& solucaoLida,
+							const vector<sServico>& vsServicos,
+							const vector<vector<int>>& vviDistancias,
+							int iDeposito,
+							int iCapacidadeVeiculo,
+							sSolucao& solucao,
+							string& sErro
+) {
+    solucao = sSolucao();
+    vector<char> vbAtendido(vsServicos.size(), 0);
+    for (const sRotaLida& rotaLida : solucaoLida.vsRotas) {
+        sRota rota;
+        int iAtual = iDeposito;
+        for (const sVisitaLida& visita : rotaLida.vsVisitas) {
+            if (visita.cTipo != 'S')
+                continue;
+            if (visita.iId < 1 || visita.iId > (int)vsServicos.size()) {
+                sErro = "servico inexistente: " + to_string(visita.iId);
+                return false;
+            }
+            if (vbAtendido[visita.iId - 1]++) {
+                sErro = "servico repetido: " + to_string(visita.iId);
+                return false;
+            }
+            sServico servico = vsServicos[visita.iId - 1];
+            // arestas podem ter sido atendidas no sentido inverso
+            if (servico.bAresta && servico.iVertice1 == visita.iVertice2 && servico.iVertice2 == visita.iVertice1)
+                swap(servico.iVertice1, servico.iVertice2);
+            rota.vsServicos.push_back(servico);
+            rota.demandaTotal += servico.demanda;
+            rota.custoTotal += vviDistancias[iAtual][servico.iVertice1] + servico.custo;
+            iAtual = servico.iVertice2;
+        }
+        if (rota.vsServicos.empty())
+            continue;
+        if (rota.demandaTotal > iCapacidadeVeiculo) {
+            sErro = "rota " + to_string(rotaLida.iId) + " excede a capacidade";
+            return false;
+        }
+        rota.custoTotal += vviDistancias[iAtual][iDeposito];
+        solucao.iCustoTotal += rota.custoTotal;
+        solucao.rotas.push_back(rota);
+    }
+    for (size_t i = 0; i < vbAtendido.size(); ++i) {
+        if (!vbAtendido[i]) {
+            sErro = "servico nao atendido: " + to_string(i + 1);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+#include "grafo.hpp"
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// Limitante inferior barato para o custo de uma solucao:
+//   custo de atendimento de todos os servicos
+// + deslocamento minimo: cada servico tem exatamente um antecessor (o deposito ou
+//   outro servico) e cada uma das, no minimo, teto(demanda/capacidade) rotas volta
+//   ao deposito. Tomando para cada servico o antecessor mais proximo (relaxacao do
+//   problema de designacao) e somando os retornos minimos obtem-se um limitante
+//   valido; o mesmo vale olhando os sucessores, e usa-se o maior dos dois.
+// Servicos em arestas podem ser atendidos nos dois sentidos, entao as duas
+// extremidades sao consideradas.
+sLimitanteInferior sCalcularLimitanteInferior(const sGrafo& grafo, const vector<vector<int>>& vviDistancias) {
+    sLimitanteInferior limitante;
+    vector<sServico> vsServicos = extrairServicos(grafo);
+    int iNumServicos = (int)vsServicos.size();
+    if (iNumServicos == 0)
+        return limitante;
+
+    long lDemandaTotal = 0;
+    for (const sServico& servico : vsServicos) {
+        limitante.iCustoServicos += servico.custo;
+        lDemandaTotal += servico.demanda;
+    }
+    limitante.iNumVeiculosMinimo = grafo.capacidadeVeiculo > 0
+        ? (int)max(1L, (lDemandaTotal + grafo.capacidadeVeiculo - 1) / grafo.capacidadeVeiculo)
+        : 1;
+
+    // Menor distancia do fim de a ate o inicio de b, considerando os sentidos permitidos
+    auto distanciaEntre = [&](const sServico& a, const sServico& b) {
+        int iMenor = vviDistancias[a.iVertice2][b.iVertice1];
+        if (a.bAresta) iMenor = min(iMenor, vviDistancias[a.iVertice1][b.iVertice1]);
+        if (b.bAresta) iMenor = min(iMenor, vviDistancias[a.iVertice2][b.iVertice2]);
+        if (a.bAresta && b.bAresta) iMenor = min(iMenor, vviDistancias[a.iVertice1][b.iVertice2]);
+        return iMenor;
+    };
+    auto distanciaDoDeposito = [&](const sServico& s) {
+        int iMenor = vviDistancias[grafo.deposito][s.iVertice1];
+        if (s.bAresta) iMenor = min(iMenor, vviDistancias[grafo.deposito][s.iVertice2]);
+        return iMenor;
+    };
+    auto distanciaAoDeposito = [&](const sServico& s) {
+        int iMenor = vviDistancias[s.iVertice2][grafo.deposito];
+        if (s.bAresta) iMenor = min(iMenor, vviDistancias[s.iVertice1][grafo.deposito]);
+        return iMenor;
+    };
+
+    long lEntradas = 0, lSaidas = 0;
+    int iMenorRetorno = INF, iMenorPartida = INF;
+    for (int i = 0; i < iNumServicos; ++i) {
+        int iMenorEntrada = distanciaDoDeposito(vsServicos[i]);
+        int iMenorSaida = distanciaAoDeposito(vsServicos[i]);
+        iMenorPartida = min(iMenorPartida, iMenorEntrada);
+        iMenorRetorno = min(iMenorRetorno, iMenorSaida);
+        for (int j = 0; j < iNumServicos; ++j) {
+            if (i == j) continue;
+            iMenorEntrada = min(iMenorEntrada, distanciaEntre(vsServicos[j], vsServicos[i]));
+            iMenorSaida = min(iMenorSaida, distanciaEntre(vsServicos[i], vsServicos[j]));
+        }
+        // Servico inalcancavel: a instancia nao tem solucao e o limitante perde o sentido
+        if (iMenorEntrada != INF) lEntradas += iMenorEntrada;
+        if (iMenorSaida != INF) lSaidas += iMenorSaida;
+    }
+    if (iMenorRetorno != INF) lEntradas += (long)limitante.iNumVeiculosMinimo * iMenorRetorno;
+    if (iMenorPartida != INF) lSaidas += (long)limitante.iNumVeiculosMinimo * iMenorPartida;
+
+    limitante.iDeslocamentoMinimo = (int)max(lEntradas, lSaidas);
+    limitante.iValor = limitante.iCustoServicos + limitante.iDeslocamentoMinimo;
+    return limitante;
+}
+
+// Gap relativo entre o custo de uma solucao e o limitante (0.05 = 5%)
+double dCalcularGap(int iCusto, const sLimitanteInferior& limitante) {
+    if (limitante.iValor <= 0) return INF;
+    return (double)(iCusto - limitante.iValor) / limitante.iValor;
+}
@@ -2,9 +2,21 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <chrono>
 #include "leitura.cpp"
+#include "caminhos_minimos.cpp"
 #include "estatisticas.cpp"
 #include "colonia_formigas.cpp"
+#include "leitura_solucao.cpp"
+#include "reotimizacao.cpp"
+#include "construtivos.cpp"
+#include "ruina_recriacao.cpp"
+#include "cache_preprocessamento.cpp"
+#include "limitantes.cpp"
+#include "varredura.cpp"
+#include "metricas.cpp"
+#include "rastreamento.cpp"
+#include "etapas.cpp"
 #include "arquivosInstancia.hpp"
 
 using namespace std;
@@ -35,95 +47,334 @@ void exibirMatrizPredecessores(const vector<vector<int>>& vviPredecessores, int
     }
 }
 
-void floydWarshall(sGrafo& Grafo, int iTamanho, vector<vector<int>>& vviDistancias, vector<vector<int>>& vviPredecessores) {
-    for (int i = 1; i < iTamanho; ++i) {
-        vviDistancias[i][i] = 0;
-        vviPredecessores[i][i] = i;
-    }
-    for (const sAresta& Aresta : Grafo.vsArestas) {
-        vviDistancias[Aresta.origem][Aresta.destino] = Aresta.custoTransito;
-        vviDistancias[Aresta.destino][Aresta.origem] = Aresta.custoTransito;
-        vviPredecessores[Aresta.origem][Aresta.destino] = Aresta.origem;
-        vviPredecessores[Aresta.destino][Aresta.origem] = Aresta.destino;
-    }
-    for (const sArco& Arco : Grafo.vsArcos) {
-        vviDistancias[Arco.origem][Arco.destino] = Arco.custoTransito;
-        vviPredecessores[Arco.origem][Arco.destino] = Arco.origem;
-    }
-    for (int k = 1; k < iTamanho; ++k) {
-        for (int i = 1; i < iTamanho; ++i) {
-            for (int j = 1; j < iTamanho; ++j) {
-                if (vviDistancias[i][k] != INF && vviDistancias[k][j] != INF && vviDistancias[i][k] + vviDistancias[k][j] < vviDistancias[i][j]) {
-                    vviDistancias[i][j] = vviDistancias[i][k] + vviDistancias[k][j];
-                    vviPredecessores[i][j] = vviPredecessores[k][j];
-                }
+// Etapas que podem ser puladas pela linha de comando
+const vector<string> vsEtapasOpcionais = {"estatisticas", "salvarEstatisticas", "solucao", "salvarSolucao"};
+
+int main(int iQtdArgumentos, char* vsArgumentos[]) {
+    sParametrosACO ParametrosACO;
+    ParametrosACO.iNumThreads = max(1, (int)thread::hardware_concurrency());
+
+    // Argumentos posicionais: formigas, iteracoes, alfa, beta.
+    // Opcoes: --deposito todas|rank|topk, --top-k N, --threads N, --target-gap G,
+    //         --instancia ARQUIVO (repetivel), --varredura ESPECIFICACAO,
+    //         --elite-busca-local K, --limite-busca-local-ms T, --vizinhos-feromonio K,
+    //         --partida-quente, --reforco-inicial R, --incremental,
+    //         --alteracoes-custo ARQUIVO, --rastreamento ARQUIVO, --matrizes-npy,
+    //         --construtivo NOME, --semente NOME, --busca-local-paralela,
+    //         --lns-ms T, --lns-aceite recozimento|recorde,
+    //         --lns-remocao todas|aleatoria|rota|proximidade, --lns-regret K,
+    //         --pular-etapa estatisticas|salvarEstatisticas|solucao|salvarSolucao (repetivel),
+    //         --etapas-sequenciais
+    int iPosicional = 0;
+    vector<string> vsArquivosSelecionados;
+    string sArquivoVarredura;
+    vector<string> vsEtapasPuladas;
+    bool bPartidaQuente = false;
+    bool bIncremental = false;
+    vector<sAlteracaoCusto> vsAlteracoesCusto;
+    string sArquivoRastreamento;
+    bool bMatrizesNpy = false;
+    bool bEtapasSequenciais = false;
+    string sConstrutivo, sSemente;
+    bool bBuscaLocalParalela = false;
+    sParametrosLNS ParametrosLNS;
+    for (int iArgumento = 1; iArgumento < iQtdArgumentos; ++iArgumento) {
+        string sArgumento = vsArgumentos[iArgumento];
+        bool bTemValor = iArgumento + 1 < iQtdArgumentos;
+        if (sArgumento == "--deposito" && bTemValor) {
+            string sPolitica = vsArgumentos[++iArgumento];
+            if (sPolitica == "rank") ParametrosACO.ePolitica = DEPOSITO_RANK;
+            else if (sPolitica == "topk") ParametrosACO.ePolitica = DEPOSITO_TOP_K;
+            else if (sPolitica == "todas") ParametrosACO.ePolitica = DEPOSITO_TODAS;
+            else {
+                cerr << "Politica de deposito desconhecida: " << sPolitica << endl;
+                return 1;
+            }
+        } else if (sArgumento == "--top-k" && bTemValor) {
+            ParametrosACO.iTopK = atoi(vsArgumentos[++iArgumento]);
+        } else if (sArgumento == "--threads" && bTemValor) {
+            ParametrosACO.iNumThreads = atoi(vsArgumentos[++iArgumento]);
+        } else if (sArgumento == "--target-gap" && bTemValor) {
+            ParametrosACO.dGapAlvo = atof(vsArgumentos[++iArgumento]);
+        } else if (sArgumento == "--elite-busca-local" && bTemValor) {
+            ParametrosACO.iEliteBuscaLocal = atoi(vsArgumentos[++iArgumento]);
+        } else if (sArgumento == "--limite-busca-local-ms" && bTemValor) {
+            ParametrosACO.dLimiteBuscaLocalMs = atof(vsArgumentos[++iArgumento]);
+        } else if (sArgumento == "--vizinhos-feromonio" && bTemValor) {
+            ParametrosACO.iVizinhosFeromonio = max(0, atoi(vsArgumentos[++iArgumento]));
+        } else if (sArgumento == "--partida-quente") {
+            bPartidaQuente = true;
+        } else if (sArgumento == "--alteracoes-custo" && bTemValor) {
+            if (!bLerAlteracoesCusto(vsArgumentos[++iArgumento], vsAlteracoesCusto))
+                return 1;
+        } else if (sArgumento == "--rastreamento" && bTemValor) {
+            sArquivoRastreamento = vsArgumentos[++iArgumento];
+            ativarRastreamento();
+        } else if ((sArgumento == "--construtivo" || sArgumento == "--semente") && bTemValor) {
+            string sNome = vsArgumentos[++iArgumento];
+            if (!bConstrutivoConhecido(sNome)) {
+                cerr << "Construtivo desconhecido: " << sNome << endl;
+                return 1;
             }
+            (sArgumento == "--construtivo" ? sConstrutivo : sSemente) = sNome;
+        } else if (sArgumento == "--busca-local-paralela") {
+            bBuscaLocalParalela = true;
+        } else if (sArgumento == "--lns-ms" && bTemValor) {
+            ParametrosLNS.dTempoLimiteMs = atof(vsArgumentos[++iArgumento]);
+        } else if (sArgumento == "--lns-aceite" && bTemValor) {
+            string sAceite = vsArgumentos[++iArgumento];
+            if (sAceite == "recorde") ParametrosLNS.aceite = ACEITE_RECORDE;
+            else if (sAceite == "recozimento") ParametrosLNS.aceite = ACEITE_RECOZIMENTO;
+            else {
+                cerr << "Criterio de aceite desconhecido: " << sAceite << endl;
+                return 1;
+            }
+        } else if (sArgumento == "--lns-remocao" && bTemValor) {
+            string sRemocao = vsArgumentos[++iArgumento];
+            if (sRemocao == "aleatoria") ParametrosLNS.remocao = REMOCAO_ALEATORIA;
+            else if (sRemocao == "rota") ParametrosLNS.remocao = REMOCAO_ROTA;
+            else if (sRemocao == "proximidade") ParametrosLNS.remocao = REMOCAO_PROXIMIDADE;
+            else if (sRemocao == "todas") ParametrosLNS.remocao = REMOCAO_TODAS;
+            else {
+                cerr << "Operador de remocao desconhecido: " << sRemocao << endl;
+                return 1;
+            }
+        } else if (sArgumento == "--lns-regret" && bTemValor) {
+            ParametrosLNS.iRegretK = max(1, atoi(vsArgumentos[++iArgumento]));
+        } else if (sArgumento == "--matrizes-npy") {
+            bMatrizesNpy = true;
+        } else if (sArgumento == "--etapas-sequenciais") {
+            bEtapasSequenciais = true;
+        } else if (sArgumento == "--incremental") {
+            bIncremental = true;
+        } else if (sArgumento == "--reforco-inicial" && bTemValor) {
+            ParametrosACO.dReforcoSolucaoInicial = atof(vsArgumentos[++iArgumento]);
+        } else if (sArgumento == "--pular-etapa" && bTemValor) {
+            string sEtapa = vsArgumentos[++iArgumento];
+            if (find(vsEtapasOpcionais.begin(), vsEtapasOpcionais.end(), sEtapa) == vsEtapasOpcionais.end()) {
+                cerr << "Etapa desconhecida ou obrigatoria: " << sEtapa << endl;
+                return 1;
+            }
+            vsEtapasPuladas.push_back(sEtapa);
+        } else if (sArgumento == "--instancia" && bTemValor) {
+            vsArquivosSelecionados.push_back(vsArgumentos[++iArgumento]);
+        } else if (sArgumento == "--varredura" && bTemValor) {
+            sArquivoVarredura = vsArgumentos[++iArgumento];
+        } else {
+            if (iPosicional == 0) ParametrosACO.iNumFormigas = atoi(vsArgumentos[iArgumento]);
+            if (iPosicional == 1) ParametrosACO.iNumIteracoes = atoi(vsArgumentos[iArgumento]);
+            if (iPosicional == 2) ParametrosACO.dInfluenciaFeromonio = atof(vsArgumentos[iArgumento]);
+            if (iPosicional == 3) ParametrosACO.dInfluenciaHeuristica = atof(vsArgumentos[iArgumento]);
+            iPosicional++;
         }
     }
-}
 
-int main(int iQtdArgumentos, char* vsArgumentos[]) {
-    int iNumFormigas = 20;
-    int iNumIteracoes = 300;
-    double dInfluenciaFeromonio = 1.0;
-    double dInfluenciaHeuristica = 3.0;
+    // Busca local final: em rodadas paralelas, com as threads do ACO
+    sOpcoesBuscaLocal OpcoesBuscaLocal;
+    if (bBuscaLocalParalela)
+        OpcoesBuscaLocal.iNumThreads = ParametrosACO.iNumThreads;
 
-    if (iQtdArgumentos > 1) iNumFormigas = atoi(vsArgumentos[1]);
-    if (iQtdArgumentos > 2) iNumIteracoes = atoi(vsArgumentos[2]);
-    if (iQtdArgumentos > 3) dInfluenciaFeromonio = atof(vsArgumentos[3]);
-    if (iQtdArgumentos > 4) dInfluenciaHeuristica = atof(vsArgumentos[4]);
+    vector<sParametrosACO> vsConfiguracoesVarredura;
+    if (!sArquivoVarredura.empty()) {
+        if (!bLerEspecificacaoVarredura(sArquivoVarredura, ParametrosACO, vsConfiguracoesVarredura))
+            return 1;
+        cout << "Modo varredura: " << vsConfiguracoesVarredura.size() << " configuracoes" << endl;
+    }
 
+    const vector<string>& vsArquivos = vsArquivosSelecionados.empty() ? vsArquivosTrabalho : vsArquivosSelecionados;
     string sNomeArquivoInstancia;
-    int iQtdArquivos = (int)vsArquivosTrabalho.size();
+    int iQtdArquivos = (int)vsArquivos.size();
     cout << "Qtd. Arquivos: " << iQtdArquivos << endl;
 
     for (int iIndiceArquivo = 0; iIndiceArquivo < iQtdArquivos; iIndiceArquivo++) {
-        clock_t tTempoInicio = clock();
-        sNomeArquivoInstancia = vsArquivosTrabalho[iIndiceArquivo];
+        auto tTempoInicio = chrono::steady_clock::now();
+        sNomeArquivoInstancia = vsArquivos[iIndiceArquivo];
         cout << "Processando arquivo " << sNomeArquivoInstancia << endl;
         bool bConseguiuLerArquivo = false;
-        
-        sGrafo Grafo = sLerArquivo(sNomeArquivoInstancia, bConseguiuLerArquivo);
-        
-        if (bConseguiuLerArquivo) {
-			
-            bool bEhDirecionado = !Grafo.vsArcos.empty();
-            int iTamanho = Grafo.iNumVertices + 1;
-            
-            vector<vector<int>> vviDistancias(iTamanho, vector<int>(iTamanho, INF));
-            vector<vector<int>> vviPredecessores(iTamanho, vector<int>(iTamanho, -1));
-            floydWarshall(Grafo, iTamanho, vviDistancias, vviPredecessores);
-            
-           // exibirMatrizDistancias(vviDistancias, Grafo.iNumVertices);
-            
-           // exibirMatrizPredecessores(vviPredecessores, Grafo.iNumVertices);
-            
-            double dDensidade = dCalcularDensidade(Grafo.iNumVertices, Grafo.vsArestas.size(), Grafo.vsArcos.size(), bEhDirecionado);
-            
-            int iGrauMinimo, iGrauMaximo;
-            calcularGraus(Grafo, Grafo.iNumVertices, iGrauMinimo, iGrauMaximo);
-            
-            int iComponentesConectados = iCalcularComponentesConectados(Grafo, Grafo.iNumVertices);
-            pair<double, int> parCaminhoMedioDiametro = calcularCaminhoMedioDiametro(vviDistancias, Grafo.iNumVertices);
-            vector<int> viIntermediacoes = viCalcularIntermediacoes(vviPredecessores, vviDistancias, Grafo.iNumVertices);
-            
-            cout << "Gerando arquivo de estatisticas" << endl;
-            exibirEstatisticasFormatadas(Grafo, dDensidade, iComponentesConectados, iGrauMinimo, iGrauMaximo, parCaminhoMedioDiametro.first, parCaminhoMedioDiametro.second, viIntermediacoes);
-            string sNomeArquivoEstatisticas = "estatisticas/estatisticas_" + Grafo.nome + ".json";
-            salvarEmArquivo(Grafo, dDensidade, iComponentesConectados, iGrauMinimo, iGrauMaximo, parCaminhoMedioDiametro.first, parCaminhoMedioDiametro.second, viIntermediacoes, sNomeArquivoEstatisticas, vviDistancias, vviPredecessores);
-            cout << "Executando solucao inicial" << endl;
-            sSolucao Solucao = executarACO(Grafo, vviDistancias, iNumFormigas, iNumIteracoes, dInfluenciaFeromonio, dInfluenciaHeuristica);
-            buscaLocal(Solucao, vviDistancias, Grafo.deposito, Grafo.capacidadeVeiculo);
-            clock_t tTempoFim = clock();
-            long lClockParaAcharSolucao = tTempoFim - tTempoInicio;
-            string sNomeArquivoSolucao = "sol-" + sNomeArquivoInstancia;
-            cout << "Salvando solucao" << endl;
-            salvarSolucaoDat(Solucao, Grafo.deposito, 1, tTempoFim, lClockParaAcharSolucao, sNomeArquivoSolucao);
-            cout << "Solucao salva em " + sNomeArquivoSolucao << endl;
+        reiniciarMetricas();
+        definirInstanciaRastreamento(sNomeArquivoInstancia);
+
+        sGrafo Grafo;
+        vector<vector<int>> vviDistancias, vviPredecessores;
+        sLimitanteInferior Limitante;
+        double dDensidade;
+        int iGrauMinimo, iGrauMaximo;
+        int iComponentesConectados;
+        pair<double, int> parCaminhoMedioDiametro;
+        vector<int> viIntermediacoes;
+        sSolucao Solucao;
+
+        // Etapas da instancia: depois dos caminhos minimos, estatisticas e solucao
+        // so leem as matrizes e rodam em paralelo
+        vector<sEtapa> vsEtapas;
+        int iLeitura = iAdicionarEtapa(vsEtapas, "leitura", {}, [&]() {
+            METRICA_FASE(FASE_LEITURA);
+            Grafo = sLerArquivo(sNomeArquivoInstancia, bConseguiuLerArquivo);
+            if (!bConseguiuLerArquivo)
+                cerr << "Erro ao abrir o arquivo!" << endl;
+            return bConseguiuLerArquivo;
+        });
+        int iCaminhosMinimos = iAdicionarEtapa(vsEtapas, "caminhosMinimos", {iLeitura}, [&]() {
+            METRICA_FASE(FASE_FLOYD_WARSHALL);
+            // No modo incremental e com alteracoes de custo as matrizes da
+            // instancia original vem do cache em disco quando a topologia nao mudou
+            bool bUsarCache = bIncremental || !vsAlteracoesCusto.empty();
+            if (!bUsarCache || !bCarregarCachePreprocessamento(Grafo, vviDistancias, vviPredecessores)) {
+                int iTamanho = Grafo.iNumVertices + 1;
+                vviDistancias.assign(iTamanho, vector<int>(iTamanho, INF));
+                vviPredecessores.assign(iTamanho, vector<int>(iTamanho, -1));
+                floydWarshall(Grafo, iTamanho, vviDistancias, vviPredecessores);
+                if (bUsarCache)
+                    salvarCachePreprocessamento(Grafo, vviDistancias, vviPredecessores);
+            }
+            // Custos alterados sao aplicados sobre as matrizes, sem novo Floyd-Warshall
+            for (const sAlteracaoCusto& alteracao : vsAlteracoesCusto)
+                if (!bAlterarCustoTransito(Grafo, alteracao.bArco, alteracao.iOrigem, alteracao.iDestino, alteracao.iNovoCusto,
+                                           vviDistancias, vviPredecessores))
+                    cerr << "Aviso: ligacao " << (alteracao.bArco ? "A " : "E ") << alteracao.iOrigem << " " << alteracao.iDestino
+                         << " nao existe em " << Grafo.nome << endl;
+            // exibirMatrizDistancias(vviDistancias, Grafo.iNumVertices);
+            // exibirMatrizPredecessores(vviPredecessores, Grafo.iNumVertices);
+            return true;
+        });
+
+        // O resumo das estatisticas e exibido depois das etapas, para nao se
+        // misturar com as mensagens da solucao, que roda ao mesmo tempo
+        int iSalvarEstatisticas = -1;
+        if (!vsConfiguracoesVarredura.empty()) {
+            // Na varredura, o mesmo pre-processamento atende todas as configuracoes
+            iAdicionarEtapa(vsEtapas, "varredura", {iCaminhosMinimos}, [&]() {
+                executarVarredura(Grafo, vviDistancias, vsConfiguracoesVarredura, ParametrosACO.iNumThreads,
+                                  "estatisticas/varredura_" + Grafo.nome + ".csv");
+                return true;
+            });
         } else {
-            cerr << "Erro ao abrir o arquivo!" << endl;
+            int iLimitante = iAdicionarEtapa(vsEtapas, "limitante", {iCaminhosMinimos}, [&]() {
+                Limitante = sCalcularLimitanteInferior(Grafo, vviDistancias);
+                return true;
+            });
+            int iEstatisticas = iAdicionarEtapa(vsEtapas, "estatisticas", {iCaminhosMinimos}, [&]() {
+                METRICA_FASE(FASE_ESTATISTICAS);
+                bool bEhDirecionado = !Grafo.vsArcos.empty();
+                dDensidade = dCalcularDensidade(Grafo.iNumVertices, Grafo.vsArestas.size(), Grafo.vsArcos.size(), bEhDirecionado);
+                calcularGraus(Grafo, Grafo.iNumVertices, iGrauMinimo, iGrauMaximo);
+                iComponentesConectados = iCalcularComponentesConectados(Grafo, Grafo.iNumVertices);
+                parCaminhoMedioDiametro = calcularCaminhoMedioDiametro(vviDistancias, Grafo.iNumVertices);
+                viIntermediacoes = viCalcularIntermediacoes(vviPredecessores, vviDistancias, Grafo.iNumVertices);
+                return true;
+            });
+            iSalvarEstatisticas = iAdicionarEtapa(vsEtapas, "salvarEstatisticas", {iEstatisticas, iLimitante}, [&]() {
+                string sNomeArquivoEstatisticas = "estatisticas/estatisticas_" + Grafo.nome + ".json";
+                METRICA_FASE(FASE_SALVAR_ESTATISTICAS);
+                return salvarEmArquivo(Grafo, dDensidade, iComponentesConectados, iGrauMinimo, iGrauMaximo, parCaminhoMedioDiametro.first, parCaminhoMedioDiametro.second, viIntermediacoes, sNomeArquivoEstatisticas, vviDistancias, vviPredecessores, Limitante, bMatrizesNpy);
+            });
+            int iSolucao = iAdicionarEtapa(vsEtapas, "solucao", {iLimitante}, [&]() {
+                // Ruina e recriacao depois da busca local (--lns-ms); a busca
+                // local roda de novo so se a LNS melhorou a solucao
+                auto aplicarLNS = [&]() {
+                    if (ParametrosLNS.dTempoLimiteMs <= 0)
+                        return;
+                    sResultadoLNS ResultadoLNS = executarLNS(Solucao, vviDistancias, Grafo.deposito, Grafo.capacidadeVeiculo, ParametrosLNS);
+                    cout << "LNS: " << ResultadoLNS.iIteracoes << " iteracoes (" << ResultadoLNS.iAceitas << " aceitas), custo "
+                         << Solucao.iCustoTotal << " -> " << ResultadoLNS.melhor.iCustoTotal << endl;
+                    if (ResultadoLNS.iMelhorias > 0) {
+                        Solucao = move(ResultadoLNS.melhor);
+                        buscaLocal(Solucao, vviDistancias, Grafo.deposito, Grafo.capacidadeVeiculo, OpcoesBuscaLocal);
+                    }
+                };
+                // Modo incremental: repara a solucao anterior em vez de rodar o ACO
+                if (bIncremental) {
+                    string sCaminho = "./solucoes/sol-" + sNomeArquivoInstancia;
+                    sSolucaoLida SolucaoLida;
+                    string sErro;
+                    if (bLerSolucaoDat(sCaminho, SolucaoLida, sErro)) {
+                        sSolucao SolucaoAnterior;
+                        sDeltaServicos Delta;
+                        montarDeltaSolucaoLida(SolucaoLida, extrairServicos(Grafo), vviDistancias, Grafo.deposito, SolucaoAnterior, Delta);
+                        cout << "Reotimizacao incremental: " << Delta.vsAdicionados.size() << " incluidos, "
+                             << Delta.viRemovidos.size() << " removidos, " << Delta.vparNovasDemandas.size() << " com nova demanda" << endl;
+                        Solucao = reotimizarSolucao(SolucaoAnterior, Delta, vviDistancias, Grafo.deposito, Grafo.capacidadeVeiculo);
+                        cout << "Custo: " << Solucao.iCustoTotal << " | limitante inferior: " << Limitante.iValor
+                             << " | gap: " << dCalcularGap(Solucao.iCustoTotal, Limitante) << endl;
+                        return true;
+                    }
+                    cerr << "Aviso: reotimizacao incremental ignorada (" << sCaminho << "): " << sErro << endl;
+                }
+                // Construtivo no lugar do ACO, seguido da busca local
+                if (!sConstrutivo.empty()) {
+                    Solucao = sExecutarConstrutivo(sConstrutivo, Grafo, vviDistancias, ParametrosACO.iNumThreads);
+                    buscaLocal(Solucao, vviDistancias, Grafo.deposito, Grafo.capacidadeVeiculo, OpcoesBuscaLocal);
+                    aplicarLNS();
+                    cout << "Custo: " << Solucao.iCustoTotal << " | limitante inferior: " << Limitante.iValor
+                         << " | gap: " << dCalcularGap(Solucao.iCustoTotal, Limitante) << endl;
+                    return true;
+                }
+                cout << "Executando solucao inicial" << endl;
+                sParametrosACO ParametrosInstancia = ParametrosACO;
+                ParametrosInstancia.iLimitanteInferior = Limitante.iValor;
+                // Partida quente: parte da solucao gravada por uma execucao anterior
+                sSolucao SolucaoInicial;
+                if (bPartidaQuente) {
+                    string sCaminho = "./solucoes/sol-" + sNomeArquivoInstancia;
+                    sSolucaoLida SolucaoLida;
+                    string sErro;
+                    if (bLerSolucaoDat(sCaminho, SolucaoLida, sErro) &&
+                        bConverterSolucaoLida(SolucaoLida, extrairServicos(Grafo), vviDistancias, Grafo.deposito,
+                                              Grafo.capacidadeVeiculo, SolucaoInicial, sErro)) {
+                        ParametrosInstancia.pSolucaoInicial = &SolucaoInicial;
+                        cout << "Partida quente a partir de " << sCaminho << " (custo " << SolucaoInicial.iCustoTotal << ")" << endl;
+                    } else {
+                        cerr << "Aviso: partida quente ignorada (" << sCaminho << "): " << sErro << endl;
+                    }
+                }
+                // Semente construtiva, quando nao ha partida quente
+                if (!sSemente.empty() && !ParametrosInstancia.pSolucaoInicial) {
+                    SolucaoInicial = sExecutarConstrutivo(sSemente, Grafo, vviDistancias, ParametrosACO.iNumThreads);
+                    ParametrosInstancia.pSolucaoInicial = &SolucaoInicial;
+                }
+                Solucao = executarACO(Grafo, vviDistancias, ParametrosInstancia);
+                // O ACO recalcula a solucao inicial com as arestas no sentido da
+                // tabela de servicos; a original pode ser mais barata
+                if (ParametrosInstancia.pSolucaoInicial && SolucaoInicial.iCustoTotal < Solucao.iCustoTotal)
+                    Solucao = SolucaoInicial;
+                buscaLocal(Solucao, vviDistancias, Grafo.deposito, Grafo.capacidadeVeiculo, OpcoesBuscaLocal);
+                aplicarLNS();
+                cout << "Custo: " << Solucao.iCustoTotal << " | limitante inferior: " << Limitante.iValor
+                     << " | gap: " << dCalcularGap(Solucao.iCustoTotal, Limitante) << endl;
+                return true;
+            });
+            iAdicionarEtapa(vsEtapas, "salvarSolucao", {iSolucao}, [&]() {
+                clock_t tTempoFim = clock();
+                // tempo de parede desde o inicio da instancia: clock() soma o tempo de
+                // CPU de todas as threads e inflaria a medida com --threads > 1
+                long lClockParaAcharSolucao = (long)(chrono::duration<double>(chrono::steady_clock::now() - tTempoInicio).count() * CLOCKS_PER_SEC);
+                string sNomeArquivoSolucao = "sol-" + sNomeArquivoInstancia;
+                cout << "Salvando solucao" << endl;
+                {
+                    METRICA_FASE(FASE_SALVAR_SOLUCAO);
+                    salvarSolucaoDat(Solucao, Grafo.deposito, 1, tTempoFim, lClockParaAcharSolucao, sNomeArquivoSolucao);
+                }
+                cout << "Solucao salva em " + sNomeArquivoSolucao << endl;
+                return true;
+            });
+        }
+        marcarEtapasPuladas(vsEtapas, vsEtapasPuladas);
+        executarEtapas(vsEtapas, bEtapasSequenciais);
+
+        if (iSalvarEstatisticas >= 0 && vsEtapas[iSalvarEstatisticas].estado == ETAPA_CONCLUIDA) {
+            cout << "Informacoes salvas em: estatisticas/estatisticas_" << Grafo.nome << ".json" << endl;
+            exibirEstatisticasFormatadas(Grafo, dDensidade, iComponentesConectados, iGrauMinimo, iGrauMaximo, parCaminhoMedioDiametro.first, parCaminhoMedioDiametro.second, viIntermediacoes);
         }
+
+        if (bConseguiuLerArquivo && vsConfiguracoesVarredura.empty())
+            salvarMetricas(Grafo.nome, "estatisticas/");
         cout << endl;
     }
+
+    if (!sArquivoRastreamento.empty()) {
+        if (!salvarRastreamento(sArquivoRastreamento))
+            return 1;
+        cout << "Rastreamento salvo em " << sArquivoRastreamento << endl;
+    }
     return 0;
 }
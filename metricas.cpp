@@ -0,0 +1,182 @@
+#include "metricas.hpp"
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+// Registro das metricas de todas as threads. Threads que terminam (como as
+// formigas de uma iteracao do ACO) devolvem seus valores em sMetricasEncerradas.
+mutex mMetricas;
+vector<sMetricas*> vpMetricasAtivas;
+sMetricas sMetricasEncerradas;
+
+struct sRegistroMetricasThread {
+    sMetricas metricas;
+
+    sRegistroMetricasThread() {
+        lock_guard<mutex> trava(mMetricas);
+        vpMetricasAtivas.push_back(&metricas);
+    }
+
+    ~sRegistroMetricasThread() {
+        lock_guard<mutex> trava(mMetricas);
+        sMetricasEncerradas.somar(metricas);
+        vpMetricasAtivas.erase(find(vpMetricasAtivas.begin(), vpMetricasAtivas.end(), &metricas));
+    }
+};
+
+// Memoria residente atual e pico (VmRSS e VmHWM de /proc/self/status), em KB
+bool bLerMemoriaProcesso(uint64_t& iAtualKb, uint64_t& iPicoKb) {
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    string sLinha;
+    iAtualKb = iPicoKb = 0;
+    while (getline(status, sLinha)) {
+        if (sLinha.compare(0, 6, "VmRSS:") == 0)
+            iAtualKb = strtoull(sLinha.c_str() + 6, nullptr, 10);
+        else if (sLinha.compare(0, 6, "VmHWM:") == 0)
+            iPicoKb = strtoull(sLinha.c_str() + 6, nullptr, 10);
+    }
+    return iAtualKb > 0;
+#else
+    iAtualKb = iPicoKb = 0;
+    return false;
+#endif
+}
+
+// Zera o pico de memoria do processo (VmHWM passa a ser a memoria atual)
+bool bZerarPicoMemoria() {
+#ifdef __linux__
+    ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.flush();
+    return clearRefs.good();
+#else
+    return false;
+#endif
+}
+
+// Picos das fases abertas em qualquer thread
+mutex mMemoriaFases;
+vector<uint64_t*> vpPicosAbertos;
+bool bPicoZeravel = true;
+
+// Repassa o pico atual do processo a todas as fases abertas (com mMemoriaFases)
+void acumularPicoFasesAbertas() {
+    uint64_t iAtualKb, iPicoKb;
+    if (!bLerMemoriaProcesso(iAtualKb, iPicoKb))
+        return;
+    uint64_t iValorKb = bPicoZeravel ? max(iAtualKb, iPicoKb) : iAtualKb;
+    for (uint64_t* piPico : vpPicosAbertos)
+        *piPico = max(*piPico, iValorKb);
+}
+
+void iniciarMemoriaFase(uint64_t* piPicoKb) {
+    lock_guard<mutex> trava(mMemoriaFases);
+    acumularPicoFasesAbertas();
+    if (bPicoZeravel)
+        bPicoZeravel = bZerarPicoMemoria();
+    vpPicosAbertos.push_back(piPicoKb);
+    acumularPicoFasesAbertas();
+}
+
+void encerrarMemoriaFase(uint64_t* piPicoKb) {
+    lock_guard<mutex> trava(mMemoriaFases);
+    acumularPicoFasesAbertas();
+    vpPicosAbertos.erase(find(vpPicosAbertos.begin(), vpPicosAbertos.end(), piPicoKb));
+}
+
+sMetricas& metricasDaThread() {
+    static thread_local sRegistroMetricasThread registro;
+    return registro.metricas;
+}
+
+sMetricas coletarMetricas() {
+    lock_guard<mutex> trava(mMetricas);
+    sMetricas total = sMetricasEncerradas;
+    for (const sMetricas* pMetricas : vpMetricasAtivas)
+        total.somar(*pMetricas);
+    return total;
+}
+
+void reiniciarMetricas() {
+    lock_guard<mutex> trava(mMetricas);
+    sMetricasEncerradas = sMetricas();
+    for (sMetricas* pMetricas : vpMetricasAtivas)
+        *pMetricas = sMetricas();
+}
+
+const char* vsNomesContadores[NUM_CONTADORES] = {
+    "candidatosAvaliados", "girosRoleta", "chamadasCustoRota", "iteracoesACO",
+    "atualizacoesFeromonio", "entradasFeromonio",
+    "twoOptTentados", "twoOptAceitos", "swapTentados", "swapAceitos",
+    "relocateTentados", "relocateAceitos", "exchangeTentados", "exchangeAceitos",
+    "orOptTentados", "orOptAceitos", "twoOptEstrelaTentados", "twoOptEstrelaAceitos",
+    "crossTentados", "crossAceitos", "lnsIteracoes", "lnsAceitas"
+};
+
+const char* vsNomesFases[NUM_FASES] = {
+    "leitura", "floydWarshall", "estatisticas", "salvarEstatisticas",
+    "aco", "acoConstrucao", "acoFeromonio", "buscaLocal", "salvarSolucao",
+    "construtivo", "lns"
+};
+
+// Grava metricas_<instancia>.json e acrescenta uma linha em metricas.csv
+void salvarMetricas(const string& sNomeInstancia, const string& sDiretorio) {
+#ifndef SEM_METRICAS
+    sMetricas metricas = coletarMetricas();
+
+    ofstream arquivoJson(sDiretorio + "metricas_" + sNomeInstancia + ".json");
+    if (!arquivoJson.is_open()) {
+        cerr << "Erro ao abrir o arquivo de metricas!" << endl;
+        return;
+    }
+    arquivoJson << "{\n";
+    arquivoJson << "  \"nome\": \"" << sNomeInstancia << "\",\n";
+    arquivoJson << "  \"contadores\": {\n";
+    for (int i = 0; i < NUM_CONTADORES; ++i)
+        arquivoJson << "    \"" << vsNomesContadores[i] << "\": " << metricas.viContadores[i]
+                    << (i < NUM_CONTADORES - 1 ? ",\n" : "\n");
+    arquivoJson << "  },\n";
+    arquivoJson << "  \"fasesNs\": {\n";
+    for (int i = 0; i < NUM_FASES; ++i)
+        arquivoJson << "    \"" << vsNomesFases[i] << "\": " << metricas.viNanossegundos[i]
+                    << (i < NUM_FASES - 1 ? ",\n" : "\n");
+    arquivoJson << "  },\n";
+    arquivoJson << "  \"memoriaPicoKb\": {\n";
+    for (int i = 0; i < NUM_FASES; ++i)
+        arquivoJson << "    \"" << vsNomesFases[i] << "\": " << metricas.viMemoriaPicoKb[i]
+                    << (i < NUM_FASES - 1 ? ",\n" : "\n");
+    arquivoJson << "  }\n";
+    arquivoJson << "}\n";
+    arquivoJson.close();
+
+    string sNomeCsv = sDiretorio + "metricas.csv";
+    bool bArquivoNovo = !ifstream(sNomeCsv).good();
+    ofstream arquivoCsv(sNomeCsv, ios::app);
+    if (!arquivoCsv.is_open()) {
+        cerr << "Erro ao abrir o arquivo de metricas!" << endl;
+        return;
+    }
+    if (bArquivoNovo) {
+        arquivoCsv << "nome";
+        for (int i = 0; i < NUM_CONTADORES; ++i) arquivoCsv << "," << vsNomesContadores[i];
+        for (int i = 0; i < NUM_FASES; ++i) arquivoCsv << "," << vsNomesFases[i] << "Ns";
+        for (int i = 0; i < NUM_FASES; ++i) arquivoCsv << "," << vsNomesFases[i] << "Kb";
+        arquivoCsv << "\n";
+    }
+    arquivoCsv << sNomeInstancia;
+    for (int i = 0; i < NUM_CONTADORES; ++i) arquivoCsv << "," << metricas.viContadores[i];
+    for (int i = 0; i < NUM_FASES; ++i) arquivoCsv << "," << metricas.viNanossegundos[i];
+    for (int i = 0; i < NUM_FASES; ++i) arquivoCsv << "," << metricas.viMemoriaPicoKb[i];
+    arquivoCsv << "\n";
+#else
+    (void)sNomeInstancia;
+    (void)sDiretorio;
+#endif
+}
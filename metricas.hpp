@@ -0,0 +1,111 @@
+#ifndef METRICAS_HPP
+#define METRICAS_HPP
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+// Instrumentacao de baixo custo dos trechos criticos (contadores e tempo por fase).
+// Os contadores ficam em memoria local de cada thread; compile com -DSEM_METRICAS
+// para remover toda a instrumentacao.
+
+enum eContador {
+    CONT_CANDIDATOS_AVALIADOS,
+    CONT_GIROS_ROLETA,
+    CONT_CHAMADAS_CUSTO_ROTA,
+    CONT_ITERACOES_ACO,
+    CONT_ATUALIZACOES_FEROMONIO,
+    CONT_ENTRADAS_FEROMONIO,
+    CONT_TWO_OPT_TENTADOS,
+    CONT_TWO_OPT_ACEITOS,
+    CONT_SWAP_TENTADOS,
+    CONT_SWAP_ACEITOS,
+    CONT_RELOCATE_TENTADOS,
+    CONT_RELOCATE_ACEITOS,
+    CONT_EXCHANGE_TENTADOS,
+    CONT_EXCHANGE_ACEITOS,
+    CONT_OR_OPT_TENTADOS,
+    CONT_OR_OPT_ACEITOS,
+    CONT_TWO_OPT_ESTRELA_TENTADOS,
+    CONT_TWO_OPT_ESTRELA_ACEITOS,
+    CONT_CROSS_TENTADOS,
+    CONT_CROSS_ACEITOS,
+    CONT_LNS_ITERACOES,
+    CONT_LNS_ACEITAS,
+    NUM_CONTADORES
+};
+
+enum eFase {
+    FASE_LEITURA,
+    FASE_FLOYD_WARSHALL,
+    FASE_ESTATISTICAS,
+    FASE_SALVAR_ESTATISTICAS,
+    FASE_ACO,
+    FASE_ACO_CONSTRUCAO,
+    FASE_ACO_FEROMONIO,
+    FASE_BUSCA_LOCAL,
+    FASE_SALVAR_SOLUCAO,
+    FASE_CONSTRUTIVO,
+    FASE_LNS,
+    NUM_FASES
+};
+
+struct sMetricas {
+    uint64_t viContadores[NUM_CONTADORES] = {};
+    uint64_t viNanossegundos[NUM_FASES] = {};
+    uint64_t viMemoriaPicoKb[NUM_FASES] = {}; // maior memoria residente do processo durante a fase
+
+    void somar(const sMetricas& outra) {
+        for (int i = 0; i < NUM_CONTADORES; ++i) viContadores[i] += outra.viContadores[i];
+        for (int i = 0; i < NUM_FASES; ++i) viNanossegundos[i] += outra.viNanossegundos[i];
+        for (int i = 0; i < NUM_FASES; ++i) viMemoriaPicoKb[i] = max(viMemoriaPicoKb[i], outra.viMemoriaPicoKb[i]);
+    }
+};
+
+// Pico de memoria por fase: o pico do processo (VmHWM) e zerado no inicio de
+// cada fase e lido no fim; fases abertas ao mesmo tempo (aninhadas ou em etapas
+// paralelas) recebem o pico lido antes de cada zeragem. O valor e do processo
+// inteiro, nao so da thread da fase. Sem /proc/self/clear_refs, vale o maior
+// entre a memoria residente no inicio e no fim da fase (0 fora do Linux).
+void iniciarMemoriaFase(uint64_t* piPicoKb);
+void encerrarMemoriaFase(uint64_t* piPicoKb);
+
+sMetricas& metricasDaThread();
+sMetricas coletarMetricas();
+void reiniciarMetricas();
+void salvarMetricas(const string& sNomeInstancia, const string& sDiretorio);
+
+// Acumula o tempo de vida do objeto na fase informada
+struct sCronometroFase {
+    eFase fase;
+    chrono::steady_clock::time_point tInicio;
+    uint64_t iPicoKb = 0;
+
+    explicit sCronometroFase(eFase faseMedida) : fase(faseMedida) {
+        iniciarMemoriaFase(&iPicoKb);
+        tInicio = chrono::steady_clock::now();
+    }
+    ~sCronometroFase() {
+        sMetricas& metricas = metricasDaThread();
+        metricas.viNanossegundos[fase] +=
+            chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - tInicio).count();
+        encerrarMemoriaFase(&iPicoKb);
+        metricas.viMemoriaPicoKb[fase] = max(metricas.viMemoriaPicoKb[fase], iPicoKb);
+    }
+};
+
+#define METRICA_CONCATENAR_(a, b) a##b
+#define METRICA_CONCATENAR(a, b) METRICA_CONCATENAR_(a, b)
+
+#ifndef SEM_METRICAS
+#define METRICA_CONTAR(contador, quantidade) (metricasDaThread().viContadores[contador] += (quantidade))
+#define METRICA_FASE(fase) sCronometroFase METRICA_CONCATENAR(cronometroFase_, __LINE__)(fase)
+#else
+#define METRICA_CONTAR(contador, quantidade) ((void)0)
+#define METRICA_FASE(fase) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+#include "rastreamento.hpp"
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+struct sEventoRastreamento {
+    const char* pNome;
+    uint64_t iInicioNs;
+    uint64_t iDuracaoNs;
+    int iInstancia;
+    int iIteracao;
+};
+
+struct sBufferRastreamento {
+    int iThread = 0;
+    vector<sEventoRastreamento> vsEventos;
+};
+
+// Os buffers ativos ficam registrados; quando uma thread termina (como as das
+// formigas de uma iteracao) seus eventos vao para vsBuffersEncerrados
+atomic<bool> bRastreamentoAtivo{false};
+mutex mRastreamento;
+vector<sBufferRastreamento*> vpBuffersAtivos;
+vector<sBufferRastreamento> vsBuffersEncerrados;
+vector<string> vsInstanciasRastreadas;
+atomic<int> iProximaThreadRastreada{1};
+const chrono::steady_clock::time_point tInicioRastreamento = chrono::steady_clock::now();
+thread_local int iInstanciaDaThread = -1;
+
+struct sRegistroRastreamentoThread {
+    sBufferRastreamento buffer;
+
+    sRegistroRastreamentoThread() {
+        buffer.iThread = iProximaThreadRastreada++;
+        buffer.vsEventos.reserve(1024);
+        lock_guard<mutex> trava(mRastreamento);
+        vpBuffersAtivos.push_back(&buffer);
+    }
+
+    ~sRegistroRastreamentoThread() {
+        lock_guard<mutex> trava(mRastreamento);
+        if (!buffer.vsEventos.empty())
+            vsBuffersEncerrados.push_back(move(buffer));
+        vpBuffersAtivos.erase(find(vpBuffersAtivos.begin(), vpBuffersAtivos.end(), &buffer));
+    }
+};
+
+void ativarRastreamento() {
+    bRastreamentoAtivo.store(true, memory_order_relaxed);
+}
+
+void definirInstanciaRastreamento(const string& sInstancia) {
+    lock_guard<mutex> trava(mRastreamento);
+    auto it = find(vsInstanciasRastreadas.begin(), vsInstanciasRastreadas.end(), sInstancia);
+    iInstanciaDaThread = (int)(it - vsInstanciasRastreadas.begin());
+    if (it == vsInstanciasRastreadas.end())
+        vsInstanciasRastreadas.push_back(sInstancia);
+}
+
+void definirInstanciaRastreamento(int iInstancia) {
+    iInstanciaDaThread = iInstancia;
+}
+
+int iInstanciaRastreamento() {
+    return iInstanciaDaThread;
+}
+
+uint64_t iInstanteRastreamentoNs() {
+    // +1 para que 0 continue significando "span nao iniciado"
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - tInicioRastreamento).count() + 1;
+}
+
+void registrarSpan(const char* pNome, uint64_t iInicioNs, uint64_t iFimNs, int iIteracao) {
+    static thread_local sRegistroRastreamentoThread registro;
+    registro.buffer.vsEventos.push_back({pNome, iInicioNs, iFimNs - iInicioNs, iInstanciaDaThread, iIteracao});
+}
+
+string sEscaparJson(const string& sTexto) {
+    string sSaida;
+    for (char c : sTexto) {
+        if (c == '"' || c == '\\')
+            sSaida += '\\';
+        sSaida += c;
+    }
+    return sSaida;
+}
+
+bool salvarRastreamento(const string& sCaminhoArquivo) {
+    ofstream arquivo(sCaminhoArquivo);
+    if (!arquivo.is_open()) {
+        cerr << "Erro ao abrir o arquivo de rastreamento: " << sCaminhoArquivo << endl;
+        return false;
+    }
+    lock_guard<mutex> trava(mRastreamento);
+    vector<const sBufferRastreamento*> vpBuffers;
+    for (const sBufferRastreamento& buffer : vsBuffersEncerrados)
+        vpBuffers.push_back(&buffer);
+    for (const sBufferRastreamento* pBuffer : vpBuffersAtivos)
+        if (!pBuffer->vsEventos.empty())
+            vpBuffers.push_back(pBuffer);
+
+    // Tempos em microssegundos, como pede o formato
+    arquivo << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool bPrimeiro = true;
+    for (const sBufferRastreamento* pBuffer : vpBuffers) {
+        arquivo << (bPrimeiro ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pBuffer->iThread
+                << ",\"args\":{\"name\":\"thread " << pBuffer->iThread << "\"}}";
+        bPrimeiro = false;
+        for (const sEventoRastreamento& evento : pBuffer->vsEventos) {
+            arquivo << ",\n{\"name\":\"" << evento.pNome << "\",\"cat\":\"carp\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pBuffer->iThread
+                    << ",\"ts\":" << evento.iInicioNs / 1000 << "." << (evento.iInicioNs % 1000) / 100
+                    << ",\"dur\":" << evento.iDuracaoNs / 1000 << "." << (evento.iDuracaoNs % 1000) / 100
+                    << ",\"args\":{\"instancia\":\""
+                    << (evento.iInstancia >= 0 ? sEscaparJson(vsInstanciasRastreadas[evento.iInstancia]) : string())
+                    << "\",\"thread\":" << pBuffer->iThread;
+            if (evento.iIteracao >= 0)
+                arquivo << ",\"iteracao\":" << evento.iIteracao;
+            arquivo << "}}";
+        }
+    }
+    arquivo << "\n]}\n";
+    return (bool)arquivo;
+}
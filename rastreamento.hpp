@@ -0,0 +1,56 @@
+#ifndef RASTREAMENTO_HPP
+#define RASTREAMENTO_HPP
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+
+using namespace std;
+
+// Rastreamento opcional de intervalos (spans) no formato de eventos do Chrome
+// (chrome://tracing ou https://ui.perfetto.dev). Cada thread grava seus eventos
+// em um buffer proprio, sem travas; desativado, cada span custa uma leitura de
+// uma flag atomica. Compile com -DSEM_RASTREAMENTO para remover os spans.
+
+extern atomic<bool> bRastreamentoAtivo;
+
+void ativarRastreamento();
+// Instancia associada aos spans da thread atual; threads criadas pelo ACO e
+// pelas etapas herdam a de quem as criou (iInstanciaRastreamento)
+void definirInstanciaRastreamento(const string& sInstancia);
+void definirInstanciaRastreamento(int iInstancia);
+int iInstanciaRastreamento();
+void registrarSpan(const char* pNome, uint64_t iInicioNs, uint64_t iFimNs, int iIteracao);
+uint64_t iInstanteRastreamentoNs();
+// Grava todos os eventos; deve ser chamada depois que as threads rastreadas terminaram
+bool salvarRastreamento(const string& sCaminhoArquivo);
+
+// Registra o tempo de vida do objeto como um span (iIteracao >= 0 vai em args)
+struct sSpan {
+    const char* pNome;
+    int iIteracao;
+    uint64_t iInicioNs = 0;
+
+    explicit sSpan(const char* pNomeSpan, int iIteracaoSpan = -1) : pNome(pNomeSpan), iIteracao(iIteracaoSpan) {
+        if (bRastreamentoAtivo.load(memory_order_relaxed))
+            iInicioNs = iInstanteRastreamentoNs();
+    }
+    ~sSpan() {
+        if (iInicioNs)
+            registrarSpan(pNome, iInicioNs, iInstanteRastreamentoNs(), iIteracao);
+    }
+};
+
+#define RASTREAR_CONCATENAR_(a, b) a##b
+#define RASTREAR_CONCATENAR(a, b) RASTREAR_CONCATENAR_(a, b)
+
+#ifndef SEM_RASTREAMENTO
+#define RASTREAR(nome) sSpan RASTREAR_CONCATENAR(span_, __LINE__)(nome)
+#define RASTREAR_ITERACAO(nome, iteracao) sSpan RASTREAR_CONCATENAR(span_, __LINE__)(nome, iteracao)
+#else
+#define RASTREAR(nome) ((void)0)
+#define RASTREAR_ITERACAO(nome, iteracao) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,247 @@
+#include "grafo.hpp"
+#include "solucao.hpp"
+#include <vector>
+#include <string>
+#include <map>
+#include <tuple>
+#include <algorithm>
+
+using namespace std;
+
+// Reotimizacao incremental: parte de uma solucao anterior e de uma pequena
+// alteracao nos servicos (inclusoes, remocoes e novas demandas) e repara apenas
+// as rotas afetadas, sem rodar o ACO de novo. Depende de colonia_formigas.cpp
+// (custoRota, atualizarRota, buscaLocal) e de leitura_solucao.cpp.
+
+// Melhor posicao encontrada para inserir um servico
+struct sInsercao {
+    int iRota = -1;          // -1: nenhuma rota comporta o servico
+    int iPosicao = 0;        // o servico entra antes desta posicao
+    long long lCusto = INF;
+    bool bInverter = false;  // aresta atendida no sentido contrario
+};
+
+// Custo de ir de iAntes ate iDepois passando pelo servico (sem o custo interno)
+long long lCustoDesvio(int iAntes, int iDepois, int iVertice1, int iVertice2, const vector<vector<int>>& vviDistancias) {
+    if (vviDistancias[iAntes][iVertice1] == INF || vviDistancias[iVertice2][iDepois] == INF)
+        return INF;
+    long long lDireto = vviDistancias[iAntes][iDepois] == INF ? 0 : vviDistancias[iAntes][iDepois];
+    return (long long)vviDistancias[iAntes][iVertice1] + vviDistancias[iVertice2][iDepois] - lDireto;
+}
+
+// Insercao mais barata do servico na rota r (arestas nos dois sentidos)
+void avaliarInsercaoRota(
+							const sRota& rota,
+							int r,
+							const sServico& servico,
+							const vector<vector<int>>& vviDistancias,
+							int iDeposito,
+							int iCapacidadeVeiculo,
+							sInsercao& melhor
+) {
+    if (rota.demandaTotal + servico.demanda > iCapacidadeVeiculo)
+        return;
+    const vector<sServico>& vsServicos = rota.vsServicos;
+    for (int k = 0; k <= (int)vsServicos.size(); ++k) {
+        int iAntes = k > 0 ? vsServicos[k - 1].iVertice2 : iDeposito;
+        int iDepois = k < (int)vsServicos.size() ? vsServicos[k].iVertice1 : iDeposito;
+        for (int iSentido = 0; iSentido < (servico.bAresta ? 2 : 1); ++iSentido) {
+            int v1 = iSentido ? servico.iVertice2 : servico.iVertice1;
+            int v2 = iSentido ? servico.iVertice1 : servico.iVertice2;
+            long long lCusto = lCustoDesvio(iAntes, iDepois, v1, v2, vviDistancias);
+            if (lCusto < melhor.lCusto) {
+                melhor.iRota = r;
+                melhor.iPosicao = k;
+                melhor.lCusto = lCusto;
+                melhor.bInverter = iSentido == 1;
+            }
+        }
+    }
+}
+
+// Economia obtida ao retirar o servico da posicao k da rota
+long long lEconomiaRemocao(const sRota& rota, int k, const vector<vector<int>>& vviDistancias, int iDeposito) {
+    const vector<sServico>& vsServicos = rota.vsServicos;
+    int iAntes = k > 0 ? vsServicos[k - 1].iVertice2 : iDeposito;
+    int iDepois = k + 1 < (int)vsServicos.size() ? vsServicos[k + 1].iVertice1 : iDeposito;
+    return lCustoDesvio(iAntes, iDepois, vsServicos[k].iVertice1, vsServicos[k].iVertice2, vviDistancias);
+}
+
+// Aplica o delta e repara as rotas afetadas:
+//  1. remove os servicos excluidos e atualiza as novas demandas;
+//  2. rotas acima da capacidade liberam servicos (maior economia de remocao
+//     entre os que resolvem o excesso, senao o de maior demanda);
+//  3. servicos liberados e incluidos entram na insercao mais barata, em ordem
+//     decrescente de demanda; sem rota que comporte, abre-se uma nova;
+//  4. busca local semeada apenas com as rotas alteradas.
+sSolucao reotimizarSolucao(
+							const sSolucao& solucaoAnterior,
+							const sDeltaServicos& delta,
+							const vector<vector<int>>& vviDistancias,
+							int iDeposito,
+							int iCapacidadeVeiculo,
+							sOpcoesBuscaLocal opcoes = sOpcoesBuscaLocal()
+) {
+    sSolucao solucao = solucaoAnterior;
+    int iNumRotas = (int)solucao.rotas.size();
+    vector<char> vbAfetada(iNumRotas, 0);
+
+    map<int, int> mNovasDemandas(delta.vparNovasDemandas.begin(), delta.vparNovasDemandas.end());
+    vector<int> viRemovidos = delta.viRemovidos;
+    sort(viRemovidos.begin(), viRemovidos.end());
+    for (int r = 0; r < iNumRotas; ++r) {
+        vector<sServico>& vsServicos = solucao.rotas[r].vsServicos;
+        size_t iAntes = vsServicos.size();
+        vsServicos.erase(remove_if(vsServicos.begin(), vsServicos.end(), [&](const sServico& servico) {
+                             return binary_search(viRemovidos.begin(), viRemovidos.end(), servico.id);
+                         }),
+                         vsServicos.end());
+        if (vsServicos.size() != iAntes)
+            vbAfetada[r] = 1;
+        for (sServico& servico : vsServicos) {
+            auto it = mNovasDemandas.find(servico.id);
+            if (it != mNovasDemandas.end()) {
+                servico.demanda = it->second;
+                vbAfetada[r] = 1;
+            }
+        }
+        if (vbAfetada[r])
+            atualizarRota(solucao.rotas[r], vviDistancias, iDeposito);
+    }
+
+    vector<sServico> vsPendentes = delta.vsAdicionados;
+    for (int r = 0; r < iNumRotas; ++r) {
+        sRota& rota = solucao.rotas[r];
+        while (rota.demandaTotal > iCapacidadeVeiculo) {
+            int iExcesso = rota.demandaTotal - iCapacidadeVeiculo;
+            int iEscolhido = 0;
+            long long lMelhorEconomia = -1;
+            bool bResolveExcesso = false;
+            for (int k = 0; k < (int)rota.vsServicos.size(); ++k) {
+                bool bResolve = rota.vsServicos[k].demanda >= iExcesso;
+                long long lEconomia = bResolve ? lEconomiaRemocao(rota, k, vviDistancias, iDeposito) : rota.vsServicos[k].demanda;
+                if ((bResolve && !bResolveExcesso) || (bResolve == bResolveExcesso && lEconomia > lMelhorEconomia)) {
+                    iEscolhido = k;
+                    lMelhorEconomia = lEconomia;
+                    bResolveExcesso = bResolve;
+                }
+            }
+            vsPendentes.push_back(rota.vsServicos[iEscolhido]);
+            rota.vsServicos.erase(rota.vsServicos.begin() + iEscolhido);
+            atualizarRota(rota, vviDistancias, iDeposito);
+        }
+    }
+
+    stable_sort(vsPendentes.begin(), vsPendentes.end(),
+                [](const sServico& a, const sServico& b) { return a.demanda > b.demanda; });
+    for (sServico servico : vsPendentes) {
+        sInsercao melhor;
+        for (int r = 0; r < (int)solucao.rotas.size(); ++r)
+            avaliarInsercaoRota(solucao.rotas[r], r, servico, vviDistancias, iDeposito, iCapacidadeVeiculo, melhor);
+        if (melhor.iRota < 0) {
+            solucao.rotas.push_back(sRota());
+            vbAfetada.push_back(1);
+            melhor.iRota = (int)solucao.rotas.size() - 1;
+            avaliarInsercaoRota(solucao.rotas[melhor.iRota], melhor.iRota, servico, vviDistancias, iDeposito, iCapacidadeVeiculo, melhor);
+        }
+        if (melhor.bInverter)
+            swap(servico.iVertice1, servico.iVertice2);
+        sRota& rota = solucao.rotas[melhor.iRota];
+        rota.vsServicos.insert(rota.vsServicos.begin() + melhor.iPosicao, servico);
+        atualizarRota(rota, vviDistancias, iDeposito);
+        vbAfetada[melhor.iRota] = 1;
+    }
+
+    // Rotas esvaziadas sao descartadas antes da busca local
+    vector<int> viRotasAfetadas;
+    vector<sRota> vsRotas;
+    for (int r = 0; r < (int)solucao.rotas.size(); ++r) {
+        if (solucao.rotas[r].vsServicos.empty())
+            continue;
+        if (vbAfetada[r])
+            viRotasAfetadas.push_back((int)vsRotas.size());
+        vsRotas.push_back(move(solucao.rotas[r]));
+    }
+    solucao.rotas = move(vsRotas);
+
+    opcoes.pRotasIniciais = &viRotasAfetadas;
+    buscaLocal(solucao, vviDistancias, iDeposito, iCapacidadeVeiculo, opcoes);
+    return solucao;
+}
+
+// Monta a solucao anterior e o delta a partir de um sol-*.dat de uma versao
+// anterior da instancia. Os servicos sao casados pelas extremidades (arestas em
+// qualquer sentido), pois os ids mudam quando servicos entram ou saem. Servicos
+// do arquivo sem correspondente recebem ids negativos e sao marcados como
+// removidos. O arquivo so guarda a demanda de cada rota, entao uma rota cuja
+// demanda recalculada difere da gravada tem todos os seus servicos marcados
+// com nova demanda.
+void montarDeltaSolucaoLida(
+							const sSolucaoLida& solucaoLida,
+							const vector<sServico>& vsServicos,
+							const vector<vector<int>>& vviDistancias,
+							int iDeposito,
+							sSolucao& solucaoAnterior,
+							sDeltaServicos& delta
+) {
+    // chave (origem, destino, aresta?) -> indices dos servicos ainda nao casados
+    map<tuple<int, int, bool>, vector<int>> mPorExtremidades;
+    for (int i = (int)vsServicos.size() - 1; i >= 0; --i) {
+        const sServico& servico = vsServicos[i];
+        int v1 = servico.iVertice1, v2 = servico.iVertice2;
+        if (servico.bAresta && v1 > v2)
+            swap(v1, v2);
+        mPorExtremidades[make_tuple(v1, v2, servico.bAresta)].push_back(i);
+    }
+    auto iCasar = [&](int v1, int v2) {
+        auto it = mPorExtremidades.find(make_tuple(v1, v2, false));
+        if (it == mPorExtremidades.end() || it->second.empty())
+            it = mPorExtremidades.find(make_tuple(min(v1, v2), max(v1, v2), true));
+        if (it == mPorExtremidades.end() || it->second.empty())
+            return -1;
+        int i = it->second.back();
+        it->second.pop_back();
+        return i;
+    };
+
+    solucaoAnterior = sSolucao();
+    delta = sDeltaServicos();
+    vector<char> vbCasado(vsServicos.size(), 0);
+    int iProximoIdRemovido = -1;
+    for (const sRotaLida& rotaLida : solucaoLida.vsRotas) {
+        sRota rota;
+        for (const sVisitaLida& visita : rotaLida.vsVisitas) {
+            if (visita.cTipo != 'S')
+                continue;
+            int i = iCasar(visita.iVertice1, visita.iVertice2);
+            sServico servico;
+            if (i < 0) {
+                servico.id = iProximoIdRemovido--;
+                servico.iVertice1 = visita.iVertice1;
+                servico.iVertice2 = visita.iVertice2;
+                servico.demanda = 0;
+                servico.custo = 0;
+                servico.atendido = true;
+                delta.viRemovidos.push_back(servico.id);
+            } else {
+                vbCasado[i] = 1;
+                servico = vsServicos[i];
+                servico.iVertice1 = visita.iVertice1;
+                servico.iVertice2 = visita.iVertice2;
+            }
+            rota.vsServicos.push_back(servico);
+        }
+        if (rota.vsServicos.empty())
+            continue;
+        atualizarRota(rota, vviDistancias, iDeposito);
+        if (rota.demandaTotal != rotaLida.iDemanda)
+            for (const sServico& servico : rota.vsServicos)
+                if (servico.id > 0)
+                    delta.vparNovasDemandas.push_back({servico.id, servico.demanda});
+        solucaoAnterior.iCustoTotal += rota.custoTotal;
+        solucaoAnterior.rotas.push_back(move(rota));
+    }
+    for (size_t i = 0; i < vsServicos.size(); ++i)
+        if (!vbCasado[i])
+            delta.vsAdicionados.push_back(vsServicos[i]);
+}
@@ -0,0 +1,310 @@
+#ifndef ROLETA_HPP
+#define ROLETA_HPP
+
+#include <cstdint>
+#include <cmath>
+
+// Nucleos da roleta de construirSolucao sobre os candidatos em estrutura de
+// vetores (vertice de inicio, demanda, custo fixo e peso em vetores separados).
+// Os pesos sao calculados e a roleta e girada com AVX2 ou AVX-512 quando a CPU
+// oferece essas extensoes; a escolha e feita uma unica vez em tempo de execucao
+// (__builtin_cpu_supports), com uma versao escalar para as demais CPUs e
+// compiladores. Compile com -DSEM_SIMD para usar sempre a versao escalar.
+
+#if !defined(SEM_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ROLETA_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+enum eNivelSimd {
+    SIMD_ESCALAR,
+    SIMD_AVX2,
+    SIMD_AVX512
+};
+
+inline const char* sNomeNivelSimd(eNivelSimd nivel) {
+    switch (nivel) {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_AVX512: return "avx512";
+        default: return "escalar";
+    }
+}
+
+// Dados da roleta no passo atual da formiga. Para cada servico pendente p, o
+// peso e feromonio(atual, p)^alfa / (ida + custo fixo + 1)^beta, ou zero se a
+// demanda nao cabe no veiculo. O custo fixo (atendimento + volta ao deposito)
+// nao depende da posicao da formiga.
+struct sEntradaRoleta {
+    const int32_t* piVertice1;
+    const int32_t* piChaveFeromonio; // posicao de cada pendente em pdFeromonioAtual
+    const int32_t* piDemanda;
+    const int32_t* piCustoFixo;
+    int iQuantidade;
+    const int* piDistanciasAtual;    // linha da matriz de distancias do vertice atual
+    const double* pdFeromonioAtual;  // feromonio da posicao atual para cada chave
+    int iCapacidadeRestante;
+    double dAlfa;
+    double dBeta;
+};
+
+// Expoente pequeno e inteiro (o caso comum, alfa = 1 e beta = 3) permite
+// potencia por multiplicacoes; nos demais casos usa-se pow, so na versao escalar
+inline int iExpoenteInteiro(double dExpoente) {
+    if (dExpoente < 0.0 || dExpoente > 8.0 || dExpoente != (double)(int)dExpoente)
+        return -1;
+    return (int)dExpoente;
+}
+
+// ---------------------------------------------------------------- escalar
+
+inline double dPotencia(double x, double dExpoente, int iExpoente) {
+    if (iExpoente < 0)
+        return pow(x, dExpoente);
+    double r = 1.0;
+    for (int k = 0; k < iExpoente; ++k)
+        r *= x;
+    return r;
+}
+
+inline double dPesoEscalar(const sEntradaRoleta& e, int p, int iAlfa, int iBeta) {
+    if (e.piDemanda[p] > e.iCapacidadeRestante)
+        return 0.0;
+    double dCusto = (double)e.piDistanciasAtual[e.piVertice1[p]] + e.piCustoFixo[p] + 1.0;
+    return dPotencia(e.pdFeromonioAtual[e.piChaveFeromonio[p]], e.dAlfa, iAlfa) / dPotencia(dCusto, e.dBeta, iBeta);
+}
+
+// Preenche pdPesos, devolve a soma e conta os candidatos que cabem no veiculo
+inline double dCalcularPesosEscalar(const sEntradaRoleta& e, double* pdPesos, int& iNumCandidatos) {
+    int iAlfa = iExpoenteInteiro(e.dAlfa), iBeta = iExpoenteInteiro(e.dBeta);
+    double dSoma = 0.0;
+    iNumCandidatos = 0;
+    for (int p = 0; p < e.iQuantidade; ++p) {
+        pdPesos[p] = dPesoEscalar(e, p, iAlfa, iBeta);
+        iNumCandidatos += e.piDemanda[p] <= e.iCapacidadeRestante;
+        dSoma += pdPesos[p];
+    }
+    return dSoma;
+}
+
+// Primeira posicao cuja soma acumulada alcanca dRoleta (0 < dRoleta <= soma);
+// -1 se o arredondamento deixar a soma acumulada abaixo de dRoleta
+inline int iEscolherEscalar(const double* pdPesos, int iQuantidade, double dRoleta) {
+    double dCumulativo = 0.0;
+    for (int p = 0; p < iQuantidade; ++p) {
+        dCumulativo += pdPesos[p];
+        if (dCumulativo >= dRoleta)
+            return p;
+    }
+    return -1;
+}
+
+#ifdef ROLETA_X86
+
+// ---------------------------------------------------------------- AVX2
+//
+// As linhas de distancia e feromonio sao lidas com cargas escalares montadas no
+// registrador: as instrucoes de gather foram mais lentas que isso nas CPUs
+// testadas (microcodigo de mitigacao), em especial com 4 posicoes.
+
+__attribute__((target("avx2")))
+inline __m256d potenciaAvx2(__m256d x, int n) {
+    __m256d r = _mm256_set1_pd(1.0);
+    for (int k = 0; k < n; ++k)
+        r = _mm256_mul_pd(r, x);
+    return r;
+}
+
+__attribute__((target("avx2")))
+inline double dCalcularPesosAvx2(const sEntradaRoleta& e, double* pdPesos, int& iNumCandidatos) {
+    int iAlfa = iExpoenteInteiro(e.dAlfa), iBeta = iExpoenteInteiro(e.dBeta);
+    if (iAlfa < 0 || iBeta < 0)
+        return dCalcularPesosEscalar(e, pdPesos, iNumCandidatos);
+
+    const __m128i capacidade = _mm_set1_epi32(e.iCapacidadeRestante);
+    const __m256d um = _mm256_set1_pd(1.0);
+    __m256d soma = _mm256_setzero_pd();
+    iNumCandidatos = 0;
+    int p = 0;
+    for (; p + 4 <= e.iQuantidade; p += 4) {
+        const int32_t* v = e.piVertice1 + p;
+        const int32_t* k = e.piChaveFeromonio + p;
+        __m128i ida = _mm_set_epi32(e.piDistanciasAtual[v[3]], e.piDistanciasAtual[v[2]], e.piDistanciasAtual[v[1]], e.piDistanciasAtual[v[0]]);
+        __m256d feromonio = _mm256_set_pd(e.pdFeromonioAtual[k[3]], e.pdFeromonioAtual[k[2]], e.pdFeromonioAtual[k[1]], e.pdFeromonioAtual[k[0]]);
+        __m128i fixo = _mm_loadu_si128((const __m128i*)(e.piCustoFixo + p));
+        __m256d custo = _mm256_add_pd(_mm256_add_pd(_mm256_cvtepi32_pd(ida), _mm256_cvtepi32_pd(fixo)), um);
+        __m256d peso = _mm256_div_pd(potenciaAvx2(feromonio, iAlfa), potenciaAvx2(custo, iBeta));
+
+        __m128i excede = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(e.piDemanda + p)), capacidade);
+        __m256d mascaraExcede = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(excede));
+        peso = _mm256_andnot_pd(mascaraExcede, peso);
+        iNumCandidatos += 4 - __builtin_popcount(_mm256_movemask_pd(mascaraExcede));
+
+        _mm256_storeu_pd(pdPesos + p, peso);
+        soma = _mm256_add_pd(soma, peso);
+    }
+    double vdSoma[4];
+    _mm256_storeu_pd(vdSoma, soma);
+    double dSoma = (vdSoma[0] + vdSoma[1]) + (vdSoma[2] + vdSoma[3]);
+    for (; p < e.iQuantidade; ++p) {
+        pdPesos[p] = dPesoEscalar(e, p, iAlfa, iBeta);
+        iNumCandidatos += e.piDemanda[p] <= e.iCapacidadeRestante;
+        dSoma += pdPesos[p];
+    }
+    return dSoma;
+}
+
+// Soma de prefixos em registrador (deslocamentos de 1 e 2 posicoes) seguida da
+// comparacao com a roleta; para no primeiro bloco que alcanca o valor sorteado
+__attribute__((target("avx2")))
+inline int iEscolherAvx2(const double* pdPesos, int iQuantidade, double dRoleta) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d roleta = _mm256_set1_pd(dRoleta);
+    __m256d acumulado = zero;
+    int p = 0;
+    for (; p + 4 <= iQuantidade; p += 4) {
+        __m256d x = _mm256_loadu_pd(pdPesos + p);
+        x = _mm256_add_pd(x, _mm256_blend_pd(_mm256_permute4x64_pd(x, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x1));
+        x = _mm256_add_pd(x, _mm256_blend_pd(_mm256_permute4x64_pd(x, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x3));
+        x = _mm256_add_pd(x, acumulado);
+        int iMascara = _mm256_movemask_pd(_mm256_cmp_pd(x, roleta, _CMP_GE_OQ));
+        if (iMascara)
+            return p + __builtin_ctz(iMascara);
+        acumulado = _mm256_permute4x64_pd(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    double dCumulativo = _mm256_cvtsd_f64(acumulado);
+    for (; p < iQuantidade; ++p) {
+        dCumulativo += pdPesos[p];
+        if (dCumulativo >= dRoleta)
+            return p;
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------- AVX-512
+
+__attribute__((target("avx512f,avx2")))
+inline __m512d potenciaAvx512(__m512d x, int n) {
+    __m512d r = _mm512_set1_pd(1.0);
+    for (int k = 0; k < n; ++k)
+        r = _mm512_mul_pd(r, x);
+    return r;
+}
+
+__attribute__((target("avx512f,avx2")))
+inline double dCalcularPesosAvx512(const sEntradaRoleta& e, double* pdPesos, int& iNumCandidatos) {
+    int iAlfa = iExpoenteInteiro(e.dAlfa), iBeta = iExpoenteInteiro(e.dBeta);
+    if (iAlfa < 0 || iBeta < 0)
+        return dCalcularPesosEscalar(e, pdPesos, iNumCandidatos);
+
+    const __m512d capacidade = _mm512_set1_pd((double)e.iCapacidadeRestante);
+    const __m512d um = _mm512_set1_pd(1.0);
+    __m512d soma = _mm512_setzero_pd();
+    iNumCandidatos = 0;
+    int p = 0;
+    for (; p + 8 <= e.iQuantidade; p += 8) {
+        const int32_t* v = e.piVertice1 + p;
+        const int32_t* k = e.piChaveFeromonio + p;
+        const int* d = e.piDistanciasAtual;
+        const double* f = e.pdFeromonioAtual;
+        __m256i ida = _mm256_set_epi32(d[v[7]], d[v[6]], d[v[5]], d[v[4]], d[v[3]], d[v[2]], d[v[1]], d[v[0]]);
+        __m512d feromonio = _mm512_maskz_insertf64x4(0xFF, _mm512_castpd256_pd512(_mm256_set_pd(f[k[3]], f[k[2]], f[k[1]], f[k[0]])),
+                                                     _mm256_set_pd(f[k[7]], f[k[6]], f[k[5]], f[k[4]]), 1);
+        __m256i fixo = _mm256_loadu_si256((const __m256i*)(e.piCustoFixo + p));
+        __m512d custo = _mm512_add_pd(_mm512_add_pd(_mm512_maskz_cvtepi32_pd(0xFF, ida), _mm512_maskz_cvtepi32_pd(0xFF, fixo)), um);
+        __m512d demanda = _mm512_maskz_cvtepi32_pd(0xFF, _mm256_loadu_si256((const __m256i*)(e.piDemanda + p)));
+        __mmask8 cabe = _mm512_cmp_pd_mask(demanda, capacidade, _CMP_LE_OQ);
+        __m512d peso = _mm512_maskz_div_pd(cabe, potenciaAvx512(feromonio, iAlfa), potenciaAvx512(custo, iBeta));
+        iNumCandidatos += __builtin_popcount((unsigned)cabe);
+        _mm512_storeu_pd(pdPesos + p, peso);
+        soma = _mm512_add_pd(soma, peso);
+    }
+    __m256d metade = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xF, soma, 0), _mm512_maskz_extractf64x4_pd(0xF, soma, 1));
+    __m128d quarto = _mm_add_pd(_mm256_castpd256_pd128(metade), _mm256_extractf128_pd(metade, 1));
+    double dSoma = _mm_cvtsd_f64(_mm_add_sd(quarto, _mm_unpackhi_pd(quarto, quarto)));
+    for (; p < e.iQuantidade; ++p) {
+        pdPesos[p] = dPesoEscalar(e, p, iAlfa, iBeta);
+        iNumCandidatos += e.piDemanda[p] <= e.iCapacidadeRestante;
+        dSoma += pdPesos[p];
+    }
+    return dSoma;
+}
+
+__attribute__((target("avx512f,avx2")))
+inline int iEscolherAvx512(const double* pdPesos, int iQuantidade, double dRoleta) {
+    const __m512i desloca1 = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+    const __m512i desloca2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0);
+    const __m512i desloca4 = _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0);
+    const __m512i ultimo = _mm512_set1_epi64(7);
+    const __m512d roleta = _mm512_set1_pd(dRoleta);
+    __m512d acumulado = _mm512_setzero_pd();
+    int p = 0;
+    for (; p + 8 <= iQuantidade; p += 8) {
+        __m512d x = _mm512_loadu_pd(pdPesos + p);
+        x = _mm512_add_pd(x, _mm512_maskz_permutexvar_pd(0xFE, desloca1, x));
+        x = _mm512_add_pd(x, _mm512_maskz_permutexvar_pd(0xFC, desloca2, x));
+        x = _mm512_add_pd(x, _mm512_maskz_permutexvar_pd(0xF0, desloca4, x));
+        x = _mm512_add_pd(x, acumulado);
+        __mmask8 alcancou = _mm512_cmp_pd_mask(x, roleta, _CMP_GE_OQ);
+        if (alcancou)
+            return p + __builtin_ctz((unsigned)alcancou);
+        acumulado = _mm512_maskz_permutexvar_pd(0xFF, ultimo, x);
+    }
+    double dCumulativo = _mm512_cvtsd_f64(acumulado);
+    for (; p < iQuantidade; ++p) {
+        dCumulativo += pdPesos[p];
+        if (dCumulativo >= dRoleta)
+            return p;
+    }
+    return -1;
+}
+
+#endif // ROLETA_X86
+
+// ---------------------------------------------------------------- despacho
+
+struct sNucleosRoleta {
+    eNivelSimd nivel = SIMD_ESCALAR;
+    double (*calcularPesos)(const sEntradaRoleta&, double*, int&) = dCalcularPesosEscalar;
+    int (*escolher)(const double*, int, double) = iEscolherEscalar;
+};
+
+inline eNivelSimd nivelSimdDisponivel() {
+#ifdef ROLETA_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+#endif
+    return SIMD_ESCALAR;
+}
+
+// Nucleos de um nivel especifico (limitado ao que a CPU suporta)
+inline sNucleosRoleta nucleosRoleta(eNivelSimd nivel) {
+    sNucleosRoleta nucleos;
+#ifdef ROLETA_X86
+    if (nivel > nivelSimdDisponivel())
+        nivel = nivelSimdDisponivel();
+    nucleos.nivel = nivel;
+    if (nivel == SIMD_AVX2) {
+        nucleos.calcularPesos = dCalcularPesosAvx2;
+        nucleos.escolher = iEscolherAvx2;
+    } else if (nivel == SIMD_AVX512) {
+        nucleos.calcularPesos = dCalcularPesosAvx512;
+        nucleos.escolher = iEscolherAvx512;
+    }
+#else
+    (void)nivel;
+#endif
+    return nucleos;
+}
+
+// Melhores nucleos para a CPU atual, detectados na primeira chamada
+inline const sNucleosRoleta& nucleosRoleta() {
+    static const sNucleosRoleta nucleos = nucleosRoleta(nivelSimdDisponivel());
+    return nucleos;
+}
+
+#endif
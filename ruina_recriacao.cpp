@@ -0,0 +1,285 @@
+#include "grafo.hpp"
+#include "solucao.hpp"
+#include "metricas.hpp"
+#include "rastreamento.hpp"
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+// Busca em vizinhanca grande (LNS) por ruina e recriacao, usada depois do ACO
+// e da busca local para aproveitar o tempo restante. Depende de
+// colonia_formigas.cpp (atualizarRota) e de reotimizacao.cpp
+// (sInsercao, avaliarInsercaoRota).
+
+enum eRemocaoLNS {
+    REMOCAO_ALEATORIA,   // servicos sorteados
+    REMOCAO_ROTA,        // rotas inteiras (ou um trecho, se a rota for maior que a cota)
+    REMOCAO_PROXIMIDADE, // um servico sorteado e os mais proximos dele
+    NUM_REMOCOES_LNS,
+    REMOCAO_TODAS = NUM_REMOCOES_LNS // sorteia uma das anteriores a cada iteracao
+};
+
+enum eAceiteLNS {
+    ACEITE_RECOZIMENTO, // recozimento simulado, temperatura caindo com o tempo
+    ACEITE_RECORDE      // record-to-record: ate dDesvioRecorde acima da melhor
+};
+
+struct sParametrosLNS {
+    double dTempoLimiteMs = 0.0; // 0 desativa a etapa
+    int iMaxIteracoes = 0;       // 0: limitado apenas pelo tempo
+    int iMinRemovidos = 4;
+    int iMaxRemovidos = 30;      // tambem limitado a 30% dos servicos
+    int iRegretK = 3;            // 1 = insercao gulosa mais barata
+    eRemocaoLNS remocao = REMOCAO_TODAS;
+    eAceiteLNS aceite = ACEITE_RECOZIMENTO;
+    double dPiorAceitoInicial = 0.005; // recozimento: solucao 0,5% pior aceita com probabilidade 1/2 no inicio
+    double dDesvioRecorde = 0.02;     // record-to-record
+    unsigned iSemente = 1;
+    const sTokenCancelamento* pCancelamento = nullptr; // opcional
+};
+
+struct sResultadoLNS {
+    sSolucao melhor;
+    int iIteracoes = 0;
+    int iAceitas = 0;
+    int iMelhorias = 0;
+};
+
+// Tabela de insercoes: vvsInsercoes[p][r] e a melhor insercao do servico
+// pendente p na rota r. Depois de uma insercao, so a coluna da rota alterada
+// e recalculada. A solucao sempre tem uma rota vazia no fim, que representa
+// a abertura de uma nova rota.
+void recriarRegret(
+					sSolucao& solucao,
+					vector<sServico>& vsPendentes,
+					const vector<vector<int>>& vviDistancias,
+					int iDeposito,
+					int iCapacidadeVeiculo,
+					int iRegretK
+) {
+    solucao.rotas.push_back(sRota());
+    int iNumPendentes = (int)vsPendentes.size();
+    vector<vector<sInsercao>> vvsInsercoes(iNumPendentes, vector<sInsercao>(solucao.rotas.size()));
+    auto avaliar = [&](int p, int r) {
+        vvsInsercoes[p][r] = sInsercao();
+        avaliarInsercaoRota(solucao.rotas[r], r, vsPendentes[p], vviDistancias, iDeposito, iCapacidadeVeiculo, vvsInsercoes[p][r]);
+    };
+    for (int p = 0; p < iNumPendentes; ++p)
+        for (int r = 0; r < (int)solucao.rotas.size(); ++r)
+            avaliar(p, r);
+
+    vector<long long> vlMelhores(max(iRegretK, 1));
+    while (iNumPendentes > 0) {
+        // regret-k: soma das diferencas entre as k melhores rotas e a melhor;
+        // rotas que faltam (menos de k viaveis) contam como muito caras
+        int iEscolhido = -1;
+        long long lMaiorRegret = -1, lMelhorCusto = INF;
+        for (int p = 0; p < iNumPendentes; ++p) {
+            fill(vlMelhores.begin(), vlMelhores.end(), (long long)INF);
+            for (const sInsercao& insercao : vvsInsercoes[p]) {
+                if (insercao.iRota < 0 || insercao.lCusto >= vlMelhores.back())
+                    continue;
+                int h = (int)vlMelhores.size() - 1;
+                while (h > 0 && vlMelhores[h - 1] > insercao.lCusto) {
+                    vlMelhores[h] = vlMelhores[h - 1];
+                    h--;
+                }
+                vlMelhores[h] = insercao.lCusto;
+            }
+            if (vlMelhores[0] >= INF)
+                continue; // inalcancavel ou maior que a capacidade
+            long long lRegret = 0;
+            for (size_t h = 1; h < vlMelhores.size(); ++h)
+                lRegret += vlMelhores[h] - vlMelhores[0];
+            if (lRegret > lMaiorRegret || (lRegret == lMaiorRegret && vlMelhores[0] < lMelhorCusto)) {
+                iEscolhido = p;
+                lMaiorRegret = lRegret;
+                lMelhorCusto = vlMelhores[0];
+            }
+        }
+        if (iEscolhido < 0)
+            break; // os restantes nao tem onde entrar
+
+        sInsercao melhor;
+        for (const sInsercao& insercao : vvsInsercoes[iEscolhido])
+            if (insercao.iRota >= 0 && insercao.lCusto < melhor.lCusto)
+                melhor = insercao;
+        sServico servico = vsPendentes[iEscolhido];
+        if (melhor.bInverter)
+            swap(servico.iVertice1, servico.iVertice2);
+        sRota& rota = solucao.rotas[melhor.iRota];
+        rota.vsServicos.insert(rota.vsServicos.begin() + melhor.iPosicao, servico);
+        atualizarRota(rota, vviDistancias, iDeposito);
+
+        // remove o pendente (troca com o ultimo) e atualiza a coluna alterada
+        iNumPendentes--;
+        vsPendentes[iEscolhido] = vsPendentes[iNumPendentes];
+        vvsInsercoes[iEscolhido].swap(vvsInsercoes[iNumPendentes]);
+        vsPendentes.pop_back();
+        vvsInsercoes.pop_back();
+        if (melhor.iRota == (int)solucao.rotas.size() - 1) {
+            solucao.rotas.push_back(sRota());
+            for (auto& vsInsercoesPendente : vvsInsercoes)
+                vsInsercoesPendente.push_back(sInsercao());
+            for (int p = 0; p < iNumPendentes; ++p)
+                avaliar(p, (int)solucao.rotas.size() - 1);
+        }
+        for (int p = 0; p < iNumPendentes; ++p)
+            avaliar(p, melhor.iRota);
+    }
+
+    solucao.rotas.erase(remove_if(solucao.rotas.begin(), solucao.rotas.end(),
+                                  [](const sRota& rota) { return rota.vsServicos.empty(); }),
+                        solucao.rotas.end());
+    solucao.iCustoTotal = 0;
+    for (const sRota& rota : solucao.rotas)
+        solucao.iCustoTotal += rota.custoTotal;
+}
+
+// Retira da solucao iQuantidade servicos escolhidos pela estrategia
+void arruinar(
+				sSolucao& solucao,
+				eRemocaoLNS remocao,
+				int iQuantidade,
+				const vector<vector<int>>& vviDistancias,
+				int iDeposito,
+				mt19937& gen,
+				vector<sServico>& vsRemovidos
+) {
+    vector<pair<int, int>> vparPosicoes; // (rota, posicao) de cada servico
+    for (int r = 0; r < (int)solucao.rotas.size(); ++r)
+        for (int k = 0; k < (int)solucao.rotas[r].vsServicos.size(); ++k)
+            vparPosicoes.push_back({r, k});
+    iQuantidade = min(iQuantidade, (int)vparPosicoes.size());
+    vector<pair<int, int>> vparRemover;
+
+    if (remocao == REMOCAO_ALEATORIA) {
+        for (int i = 0; i < iQuantidade; ++i) {
+            int j = uniform_int_distribution<int>(i, (int)vparPosicoes.size() - 1)(gen);
+            swap(vparPosicoes[i], vparPosicoes[j]);
+            vparRemover.push_back(vparPosicoes[i]);
+        }
+    } else if (remocao == REMOCAO_ROTA) {
+        vector<int> viRotas(solucao.rotas.size());
+        for (int r = 0; r < (int)viRotas.size(); ++r)
+            viRotas[r] = r;
+        shuffle(viRotas.begin(), viRotas.end(), gen);
+        for (int r : viRotas) {
+            int iRestantes = iQuantidade - (int)vparRemover.size();
+            if (iRestantes <= 0)
+                break;
+            int iTamanho = (int)solucao.rotas[r].vsServicos.size();
+            int iInicio = iTamanho > iRestantes ? uniform_int_distribution<int>(0, iTamanho - iRestantes)(gen) : 0;
+            for (int k = iInicio; k < min(iTamanho, iInicio + iRestantes); ++k)
+                vparRemover.push_back({r, k});
+        }
+    } else {
+        // proximidade: d(fim da semente, inicio de x) + d(fim de x, inicio da semente)
+        int iSemente = uniform_int_distribution<int>(0, (int)vparPosicoes.size() - 1)(gen);
+        const sServico& semente = solucao.rotas[vparPosicoes[iSemente].first].vsServicos[vparPosicoes[iSemente].second];
+        vector<pair<long long, int>> vparProximidade;
+        for (int i = 0; i < (int)vparPosicoes.size(); ++i) {
+            const sServico& servico = solucao.rotas[vparPosicoes[i].first].vsServicos[vparPosicoes[i].second];
+            long long lProximidade = i == iSemente ? -1 :
+                (long long)vviDistancias[semente.iVertice2][servico.iVertice1] + vviDistancias[servico.iVertice2][semente.iVertice1];
+            vparProximidade.push_back({lProximidade, i});
+        }
+        nth_element(vparProximidade.begin(), vparProximidade.begin() + (iQuantidade - 1), vparProximidade.end());
+        for (int i = 0; i < iQuantidade; ++i)
+            vparRemover.push_back(vparPosicoes[vparProximidade[i].second]);
+    }
+
+    // remocao de tras para frente em cada rota, para nao deslocar posicoes
+    sort(vparRemover.begin(), vparRemover.end(), greater<pair<int, int>>());
+    for (const auto& posicao : vparRemover) {
+        vector<sServico>& vsServicos = solucao.rotas[posicao.first].vsServicos;
+        vsRemovidos.push_back(vsServicos[posicao.second]);
+        vsServicos.erase(vsServicos.begin() + posicao.second);
+    }
+    for (int r = (int)solucao.rotas.size() - 1; r >= 0; --r) {
+        if (solucao.rotas[r].vsServicos.empty())
+            solucao.rotas.erase(solucao.rotas.begin() + r);
+        else
+            atualizarRota(solucao.rotas[r], vviDistancias, iDeposito);
+    }
+}
+
+// Ruina e recriacao ate o tempo limite (ou iMaxIteracoes), partindo da
+// solucao informada; devolve a melhor encontrada
+sResultadoLNS executarLNS(
+							const sSolucao& solucaoInicial,
+							const vector<vector<int>>& vviDistancias,
+							int iDeposito,
+							int iCapacidadeVeiculo,
+							const sParametrosLNS& parametros
+) {
+    METRICA_FASE(FASE_LNS);
+    RASTREAR("lns");
+    sResultadoLNS resultado;
+    resultado.melhor = solucaoInicial;
+    sSolucao atual = solucaoInicial;
+    int iNumServicos = 0;
+    for (const sRota& rota : atual.rotas)
+        iNumServicos += (int)rota.vsServicos.size();
+    if (iNumServicos < 2)
+        return resultado;
+
+    int iMaxRemovidos = max(1, min(parametros.iMaxRemovidos, max(2, (int)(0.3 * iNumServicos))));
+    int iMinRemovidos = max(1, min(parametros.iMinRemovidos, iMaxRemovidos));
+    mt19937 gen(parametros.iSemente);
+    uniform_real_distribution<double> dis(0.0, 1.0);
+
+    // temperatura inicial: solucao dPiorAceitoInicial pior aceita com probabilidade 1/2;
+    // cai exponencialmente ate 1/1000 disso no fim do prazo
+    double dTemperaturaInicial = parametros.dPiorAceitoInicial * solucaoInicial.iCustoTotal / log(2.0);
+    auto tInicio = chrono::steady_clock::now();
+    vector<sServico> vsRemovidos;
+    while (true) {
+        double dDecorridoMs = chrono::duration<double, milli>(chrono::steady_clock::now() - tInicio).count();
+        double dFracao = parametros.iMaxIteracoes > 0 ? (double)resultado.iIteracoes / parametros.iMaxIteracoes
+                                                     : dDecorridoMs / max(parametros.dTempoLimiteMs, 1e-9);
+        if (parametros.iMaxIteracoes > 0 && resultado.iIteracoes >= parametros.iMaxIteracoes)
+            break;
+        if (parametros.iMaxIteracoes <= 0 && dDecorridoMs >= parametros.dTempoLimiteMs)
+            break;
+        if (parametros.pCancelamento && parametros.pCancelamento->bCancelado())
+            break;
+        resultado.iIteracoes++;
+        METRICA_CONTAR(CONT_LNS_ITERACOES, 1);
+
+        sSolucao candidata = atual;
+        eRemocaoLNS remocao = parametros.remocao == REMOCAO_TODAS
+                                  ? (eRemocaoLNS)uniform_int_distribution<int>(0, NUM_REMOCOES_LNS - 1)(gen)
+                                  : parametros.remocao;
+        vsRemovidos.clear();
+        arruinar(candidata, remocao, uniform_int_distribution<int>(iMinRemovidos, iMaxRemovidos)(gen),
+                 vviDistancias, iDeposito, gen, vsRemovidos);
+        recriarRegret(candidata, vsRemovidos, vviDistancias, iDeposito, iCapacidadeVeiculo, parametros.iRegretK);
+        if (!vsRemovidos.empty())
+            continue; // algum servico ficou sem rota: candidata descartada
+
+        bool bAceitar = candidata.iCustoTotal < atual.iCustoTotal;
+        if (!bAceitar && parametros.aceite == ACEITE_RECOZIMENTO) {
+            double dTemperatura = dTemperaturaInicial * pow(1e-3, min(dFracao, 1.0));
+            bAceitar = dis(gen) < exp(-(candidata.iCustoTotal - atual.iCustoTotal) / dTemperatura);
+        } else if (!bAceitar) {
+            bAceitar = candidata.iCustoTotal <= resultado.melhor.iCustoTotal * (1.0 + parametros.dDesvioRecorde);
+        }
+        if (!bAceitar)
+            continue;
+        resultado.iAceitas++;
+        METRICA_CONTAR(CONT_LNS_ACEITAS, 1);
+        atual = move(candidata);
+        if (atual.iCustoTotal < resultado.melhor.iCustoTotal) {
+            resultado.melhor = atual;
+            resultado.iMelhorias++;
+        }
+    }
+    return resultado;
+}
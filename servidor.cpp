@@ -0,0 +1,454 @@
+#include "biblioteca.cpp"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <ctime>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Servidor do resolvedor em um socket Unix local. Mantem em memoria um cache LRU
+// dos pre-processamentos (matrizes do Floyd-Warshall) indexado pelo hash da
+// topologia, de modo que requisicoes sobre a mesma malha viaria nao repetem a
+// leitura das matrizes nem o Floyd-Warshall. As requisicoes sao atendidas por um
+// conjunto fixo de threads; entre requisicoes, as conexoes ociosas ficam com a
+// thread principal (poll), e nao presas a um trabalhador.
+//
+// Uso: servidor [--socket CAMINHO] [--trabalhadores N] [--cache N]
+//
+// Protocolo (uma ou mais requisicoes por conexao):
+//   RESOLVER <bytes> [formigas=N iteracoes=N alfa=A beta=B threads=N gap=G elite=K busca-local=0|1]
+//       seguido de <bytes> bytes com o conteudo do .dat; resposta
+//       "OK <bytes>\n" e a solucao no formato de salvarSolucaoDat
+//   INSTANCIA <bytes>
+//       seguido do .dat; apenas pre-processa e guarda no cache; resposta
+//       "OK <hash> acerto|falta\n"
+//   ESTATISTICAS
+//       resposta "OK <bytes>\n" e um JSON com acertos/faltas do cache e latencias
+// Erros sao respondidos com "ERRO <mensagem>\n".
+
+const string SOCKET_PADRAO = "/tmp/carp.sock";
+const int CAPACIDADE_CACHE_PADRAO = 8;
+const size_t MAX_BYTES_REQUISICAO = 256u << 20;
+const size_t MAX_LATENCIAS_GUARDADAS = 10000;
+// Uma requisicao iniciada deve chegar por inteiro dentro deste prazo (SO_RCVTIMEO)
+const int SEGUNDOS_LIMITE_LEITURA = 30;
+
+// Cache LRU de pre-processamentos. Cada entrada guarda um shared_future, entao
+// requisicoes simultaneas sobre uma topologia ainda nao processada esperam o
+// mesmo Floyd-Warshall em vez de repeti-lo.
+struct sCachePreprocessamentos {
+    struct sEntrada {
+        uint64_t iHash;
+        uint64_t iSerie; // distingue entradas sucessivas do mesmo hash
+        shared_future<shared_ptr<const sPreprocessamento>> futuro;
+    };
+
+    size_t iCapacidade;
+    list<sEntrada> lsEntradas; // da mais recente para a menos recente
+    unordered_map<uint64_t, list<sEntrada>::iterator> mIndice;
+    uint64_t iProximaSerie = 0;
+    mutex mCache;
+
+    explicit sCachePreprocessamentos(size_t iCapacidadeCache) : iCapacidade(max<size_t>(1, iCapacidadeCache)) {}
+
+    shared_ptr<const sPreprocessamento> pObter(const sGrafo& grafo, uint64_t iHash, bool& bAcerto) {
+        promise<shared_ptr<const sPreprocessamento>> promessa;
+        shared_future<shared_ptr<const sPreprocessamento>> futuro;
+        uint64_t iSerie = 0;
+        {
+            lock_guard<mutex> trava(mCache);
+            auto it = mIndice.find(iHash);
+            bAcerto = it != mIndice.end();
+            if (bAcerto) {
+                lsEntradas.splice(lsEntradas.begin(), lsEntradas, it->second);
+                futuro = it->second->futuro;
+            } else {
+                futuro = promessa.get_future().share();
+                iSerie = iProximaSerie++;
+                lsEntradas.push_front({iHash, iSerie, futuro});
+                mIndice[iHash] = lsEntradas.begin();
+                while (lsEntradas.size() > iCapacidade) {
+                    mIndice.erase(lsEntradas.back().iHash);
+                    lsEntradas.pop_back();
+                }
+            }
+        }
+        if (!bAcerto) {
+            try {
+                promessa.set_value(pPreprocessar(grafo));
+            } catch (...) {
+                // falha (ex.: memoria insuficiente) nao fica no cache
+                promessa.set_exception(current_exception());
+                lock_guard<mutex> trava(mCache);
+                auto it = mIndice.find(iHash);
+                if (it != mIndice.end() && it->second->iSerie == iSerie) {
+                    lsEntradas.erase(it->second);
+                    mIndice.erase(it);
+                }
+            }
+        }
+        return futuro.get();
+    }
+
+    void resumo(size_t& iEntradas, size_t& iBytes) {
+        lock_guard<mutex> trava(mCache);
+        iEntradas = lsEntradas.size();
+        iBytes = 0;
+        for (const sEntrada& entrada : lsEntradas)
+            if (entrada.futuro.wait_for(chrono::seconds(0)) == future_status::ready)
+                iBytes += entrada.futuro.get()->iBytes();
+    }
+};
+
+struct sEstatisticasServidor {
+    atomic<uint64_t> iRequisicoes{0}, iAcertos{0}, iFaltas{0}, iErros{0};
+    mutex mLatencias;
+    vector<double> vdLatenciasMs; // janela circular das ultimas requisicoes
+    size_t iProximaLatencia = 0;
+    double dLatenciaMaximaMs = 0.0;
+
+    void registrarLatencia(double dMs) {
+        lock_guard<mutex> trava(mLatencias);
+        if (vdLatenciasMs.size() < MAX_LATENCIAS_GUARDADAS)
+            vdLatenciasMs.push_back(dMs);
+        else
+            vdLatenciasMs[iProximaLatencia++ % MAX_LATENCIAS_GUARDADAS] = dMs;
+        dLatenciaMaximaMs = max(dLatenciaMaximaMs, dMs);
+    }
+
+    string sJson(sCachePreprocessamentos& cache) {
+        vector<double> vdOrdenadas;
+        double dMaxima;
+        {
+            lock_guard<mutex> trava(mLatencias);
+            vdOrdenadas = vdLatenciasMs;
+            dMaxima = dLatenciaMaximaMs;
+        }
+        sort(vdOrdenadas.begin(), vdOrdenadas.end());
+        auto dPercentil = [&](double p) {
+            return vdOrdenadas.empty() ? 0.0 : vdOrdenadas[(size_t)(p * (vdOrdenadas.size() - 1))];
+        };
+        double dMedia = 0.0;
+        for (double d : vdOrdenadas) dMedia += d;
+        if (!vdOrdenadas.empty()) dMedia /= vdOrdenadas.size();
+        size_t iEntradas, iBytes;
+        cache.resumo(iEntradas, iBytes);
+
+        ostringstream json;
+        json << fixed << setprecision(3);
+        json << "{\n"
+             << "  \"requisicoes\": " << iRequisicoes << ",\n"
+             << "  \"acertosCache\": " << iAcertos << ",\n"
+             << "  \"faltasCache\": " << iFaltas << ",\n"
+             << "  \"erros\": " << iErros << ",\n"
+             << "  \"entradasCache\": " << iEntradas << ",\n"
+             << "  \"capacidadeCache\": " << cache.iCapacidade << ",\n"
+             << "  \"bytesCache\": " << iBytes << ",\n"
+             << "  \"latenciaMediaMs\": " << dMedia << ",\n"
+             << "  \"latenciaP50Ms\": " << dPercentil(0.50) << ",\n"
+             << "  \"latenciaP95Ms\": " << dPercentil(0.95) << ",\n"
+             << "  \"latenciaMaximaMs\": " << dMaxima << "\n"
+             << "}\n";
+        return json.str();
+    }
+};
+
+// Leitura com buffer de um socket: linhas terminadas em '\n' e blocos de tamanho fixo
+struct sConexao {
+    int iDescritor;
+    string sBuffer;
+
+    bool bPreencher() {
+        char vcBloco[1 << 16];
+        ssize_t iLidos = recv(iDescritor, vcBloco, sizeof(vcBloco), 0);
+        if (iLidos <= 0)
+            return false;
+        sBuffer.append(vcBloco, iLidos);
+        return true;
+    }
+    bool bLerLinha(string& sLinha) {
+        size_t iFim;
+        while ((iFim = sBuffer.find('\n')) == string::npos)
+            if (sBuffer.size() > 4096 || !bPreencher())
+                return false;
+        sLinha = sBuffer.substr(0, iFim);
+        if (!sLinha.empty() && sLinha.back() == '\r')
+            sLinha.pop_back();
+        sBuffer.erase(0, iFim + 1);
+        return true;
+    }
+    bool bLerBytes(size_t iQuantidade, string& sDados) {
+        while (sBuffer.size() < iQuantidade)
+            if (!bPreencher())
+                return false;
+        sDados = sBuffer.substr(0, iQuantidade);
+        sBuffer.erase(0, iQuantidade);
+        return true;
+    }
+    bool bEnviar(const string& sDados) {
+        size_t iEnviados = 0;
+        while (iEnviados < sDados.size()) {
+            ssize_t iParte = send(iDescritor, sDados.data() + iEnviados, sDados.size() - iEnviados, MSG_NOSIGNAL);
+            if (iParte <= 0)
+                return false;
+            iEnviados += iParte;
+        }
+        return true;
+    }
+};
+
+// Aplica as opcoes chave=valor da linha de RESOLVER
+bool bInterpretarOpcoes(istringstream& entrada, sOpcoesResolvedor& opcoes, string& sErro) {
+    string sOpcao;
+    while (entrada >> sOpcao) {
+        size_t iIgual = sOpcao.find('=');
+        if (iIgual == string::npos) {
+            sErro = "opcao sem valor: " + sOpcao;
+            return false;
+        }
+        string sChave = sOpcao.substr(0, iIgual);
+        string sValor = sOpcao.substr(iIgual + 1);
+        sParametrosACO& aco = opcoes.parametrosACO;
+        try {
+            if (sChave == "formigas") aco.iNumFormigas = stoi(sValor);
+            else if (sChave == "iteracoes") aco.iNumIteracoes = stoi(sValor);
+            else if (sChave == "alfa") aco.dInfluenciaFeromonio = stod(sValor);
+            else if (sChave == "beta") aco.dInfluenciaHeuristica = stod(sValor);
+            else if (sChave == "threads") aco.iNumThreads = max(1, stoi(sValor));
+            else if (sChave == "gap") aco.dGapAlvo = stod(sValor);
+            else if (sChave == "elite") aco.iEliteBuscaLocal = stoi(sValor);
+            else if (sChave == "vizinhos") aco.iVizinhosFeromonio = max(0, stoi(sValor));
+            else if (sChave == "busca-local") opcoes.bBuscaLocal = sValor != "0";
+            else {
+                sErro = "opcao desconhecida: " + sChave;
+                return false;
+            }
+        } catch (const exception&) {
+            sErro = "valor invalido para " + sChave;
+            return false;
+        }
+    }
+    return true;
+}
+
+// bConexaoPerdida indica que o restante da requisicao nao chegou e a conexao deve ser encerrada
+bool bLerInstancia(sConexao& conexao, istringstream& entrada, sGrafo& grafo, string& sErro, bool& bConexaoPerdida) {
+    long long lBytes = -1;
+    if (!(entrada >> lBytes) || lBytes <= 0 || (size_t)lBytes > MAX_BYTES_REQUISICAO) {
+        sErro = "tamanho invalido";
+        return false;
+    }
+    string sDados;
+    if (!conexao.bLerBytes((size_t)lBytes, sDados)) {
+        sErro = "conexao encerrada antes do fim da instancia";
+        bConexaoPerdida = true;
+        return false;
+    }
+    istringstream conteudo(sDados);
+    bool bConseguiuLer = false;
+    grafo = sLerGrafo(conteudo, "<requisicao>", bConseguiuLer, false);
+    if (!bConseguiuLer) {
+        sErro = "conteudo .dat invalido";
+        return false;
+    }
+    return bValidarGrafo(grafo, sErro);
+}
+
+// Atende uma requisicao da conexao; devolve false se a conexao deve ser encerrada
+bool bAtenderRequisicao(sConexao& conexao, sCachePreprocessamentos& cache, sEstatisticasServidor& estatisticas) {
+    string sLinha;
+    if (!conexao.bLerLinha(sLinha))
+        return false;
+    auto tInicio = chrono::steady_clock::now();
+    istringstream entrada(sLinha);
+    string sComando;
+    entrada >> sComando;
+    string sResposta, sErro;
+
+    if (sComando == "ESTATISTICAS") {
+        string sJson = estatisticas.sJson(cache);
+        return conexao.bEnviar("OK " + to_string(sJson.size()) + "\n" + sJson);
+    }
+
+    estatisticas.iRequisicoes++;
+    sGrafo grafo;
+    bool bConexaoPerdida = false;
+    if (sComando != "RESOLVER" && sComando != "INSTANCIA") {
+        sErro = "comando desconhecido: " + sComando;
+    } else if (bLerInstancia(conexao, entrada, grafo, sErro, bConexaoPerdida)) {
+        uint64_t iHash = iHashTopologia(grafo);
+        bool bAcerto = false;
+        shared_ptr<const sPreprocessamento> preprocessamento;
+        try {
+            preprocessamento = cache.pObter(grafo, iHash, bAcerto);
+        } catch (const exception& e) {
+            sErro = string("falha no pre-processamento: ") + e.what();
+        }
+        (bAcerto ? estatisticas.iAcertos : estatisticas.iFaltas)++;
+
+        if (!preprocessamento) {
+            // erro ja registrado
+        } else if (sComando == "INSTANCIA") {
+            ostringstream resposta;
+            resposta << "OK " << hex << iHash << dec << (bAcerto ? " acerto\n" : " falta\n");
+            sResposta = resposta.str();
+        } else {
+            sOpcoesResolvedor opcoes;
+            opcoes.parametrosACO.iNumThreads = 1; // o paralelismo vem das requisicoes simultaneas
+            if (bInterpretarOpcoes(entrada, opcoes, sErro)) {
+                sResultadoResolvedor resultado = resolverPreprocessado(grafo, *preprocessamento, opcoes);
+                long lClocks = (long)(chrono::duration<double>(chrono::steady_clock::now() - tInicio).count() * CLOCKS_PER_SEC);
+                ostringstream solucao;
+                escreverSolucaoDat(solucao, resultado.solucao, grafo.deposito, 1, lClocks, lClocks);
+                sResposta = "OK " + to_string(solucao.str().size()) + "\n" + solucao.str();
+            }
+        }
+    }
+
+    if (!sErro.empty()) {
+        estatisticas.iErros++;
+        sResposta = "ERRO " + sErro + "\n";
+    }
+    estatisticas.registrarLatencia(chrono::duration<double, milli>(chrono::steady_clock::now() - tInicio).count());
+    return conexao.bEnviar(sResposta) && !bConexaoPerdida;
+}
+
+int main(int iQtdArgumentos, char* vsArgumentos[]) {
+    string sCaminhoSocket = SOCKET_PADRAO;
+    int iNumTrabalhadores = max(1, (int)thread::hardware_concurrency());
+    int iCapacidadeCache = CAPACIDADE_CACHE_PADRAO;
+    for (int iArgumento = 1; iArgumento + 1 < iQtdArgumentos; iArgumento += 2) {
+        string sArgumento = vsArgumentos[iArgumento];
+        if (sArgumento == "--socket") sCaminhoSocket = vsArgumentos[iArgumento + 1];
+        else if (sArgumento == "--trabalhadores") iNumTrabalhadores = max(1, atoi(vsArgumentos[iArgumento + 1]));
+        else if (sArgumento == "--cache") iCapacidadeCache = max(1, atoi(vsArgumentos[iArgumento + 1]));
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    int iSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un endereco{};
+    endereco.sun_family = AF_UNIX;
+    if (iSocket < 0 || sCaminhoSocket.size() >= sizeof(endereco.sun_path)) {
+        cerr << "Erro ao criar o socket " << sCaminhoSocket << endl;
+        return 1;
+    }
+    strncpy(endereco.sun_path, sCaminhoSocket.c_str(), sizeof(endereco.sun_path) - 1);
+    unlink(sCaminhoSocket.c_str());
+    if (bind(iSocket, (sockaddr*)&endereco, sizeof(endereco)) != 0 || listen(iSocket, 64) != 0) {
+        cerr << "Erro ao escutar em " << sCaminhoSocket << ": " << strerror(errno) << endl;
+        return 1;
+    }
+
+    // Canal para os trabalhadores acordarem o poll quando devolvem uma conexao
+    int viAvisos[2];
+    if (pipe(viAvisos) != 0) {
+        cerr << "Erro ao criar o canal de avisos: " << strerror(errno) << endl;
+        return 1;
+    }
+
+    sCachePreprocessamentos cache(iCapacidadeCache);
+    sEstatisticasServidor estatisticas;
+    // fpConexoes: conexoes com uma requisicao chegando, a espera de um trabalhador;
+    // vpDevolvidas: conexoes que os trabalhadores terminaram de atender e voltam ao poll
+    mutex mFila;
+    condition_variable cvFila;
+    queue<shared_ptr<sConexao>> fpConexoes;
+    vector<shared_ptr<sConexao>> vpDevolvidas;
+
+    vector<thread> vTrabalhadores;
+    for (int t = 0; t < iNumTrabalhadores; ++t) {
+        vTrabalhadores.emplace_back([&]() {
+            while (true) {
+                shared_ptr<sConexao> conexao;
+                {
+                    unique_lock<mutex> trava(mFila);
+                    cvFila.wait(trava, [&]() { return !fpConexoes.empty(); });
+                    conexao = fpConexoes.front();
+                    fpConexoes.pop();
+                }
+                if (!bAtenderRequisicao(*conexao, cache, estatisticas)) {
+                    close(conexao->iDescritor);
+                    continue;
+                }
+                lock_guard<mutex> trava(mFila);
+                if (conexao->sBuffer.find('\n') != string::npos) {
+                    // o cliente ja enviou a proxima requisicao
+                    fpConexoes.push(conexao);
+                    cvFila.notify_one();
+                } else {
+                    vpDevolvidas.push_back(conexao);
+                    char cAviso = 0;
+                    (void)!write(viAvisos[1], &cAviso, 1);
+                }
+            }
+        });
+    }
+
+    cout << "Servidor escutando em " << sCaminhoSocket << " (" << iNumTrabalhadores
+         << " trabalhadores, cache de " << iCapacidadeCache << " grafos)" << endl;
+    vector<shared_ptr<sConexao>> vpOciosas;
+    vector<pollfd> vsDescritores;
+    while (true) {
+        vsDescritores.assign({{iSocket, POLLIN, 0}, {viAvisos[0], POLLIN, 0}});
+        for (const auto& conexao : vpOciosas)
+            vsDescritores.push_back({conexao->iDescritor, POLLIN, 0});
+        if (poll(vsDescritores.data(), vsDescritores.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            cerr << "Erro em poll: " << strerror(errno) << endl;
+            break;
+        }
+
+        // Conexoes ociosas com dados (ou encerradas) vao para a fila dos trabalhadores
+        vector<shared_ptr<sConexao>> vpProntas, vpAindaOciosas;
+        for (size_t c = 0; c < vpOciosas.size(); ++c)
+            (vsDescritores[c + 2].revents ? vpProntas : vpAindaOciosas).push_back(vpOciosas[c]);
+        vpOciosas.swap(vpAindaOciosas);
+        if (vsDescritores[1].revents & POLLIN) {
+            char vcAvisos[256];
+            (void)!read(viAvisos[0], vcAvisos, sizeof(vcAvisos));
+            lock_guard<mutex> trava(mFila);
+            vpOciosas.insert(vpOciosas.end(), vpDevolvidas.begin(), vpDevolvidas.end());
+            vpDevolvidas.clear();
+        }
+        if (vsDescritores[0].revents & POLLIN) {
+            int iCliente = accept(iSocket, nullptr, nullptr);
+            if (iCliente >= 0) {
+                timeval limite{SEGUNDOS_LIMITE_LEITURA, 0};
+                setsockopt(iCliente, SOL_SOCKET, SO_RCVTIMEO, &limite, sizeof(limite));
+                vpOciosas.push_back(make_shared<sConexao>(sConexao{iCliente, ""}));
+            } else if (errno != EINTR && errno != EAGAIN) {
+                cerr << "Erro em accept: " << strerror(errno) << endl;
+                break;
+            }
+        }
+        if (!vpProntas.empty()) {
+            lock_guard<mutex> trava(mFila);
+            for (auto& conexao : vpProntas)
+                fpConexoes.push(conexao);
+            cvFila.notify_all();
+        }
+    }
+    close(iSocket);
+    for (auto& th : vTrabalhadores)
+        th.detach();
+    return 1;
+}
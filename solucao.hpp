@@ -0,0 +1,82 @@
+#ifndef SOLUCAO_HPP
+#define SOLUCAO_HPP
+
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+const double TAXA_EVAPORACAO_FEROMONIO = 0.2; // Taxa de evaporacao padrao
+
+// Representa um servico (no, aresta ou arco requerido)
+struct sServico {
+    int id;
+    int iVertice1, iVertice2; // extremidades
+    int demanda;
+    int custo;
+    bool atendido;
+    bool bAresta = false; // servico em aresta pode ser atendido nos dois sentidos
+};
+
+// Representa uma rota construída por uma formiga
+struct sRota {
+    vector<sServico> vsServicos;
+    int demandaTotal = 0;
+    int custoTotal = 0;
+};
+
+// Representa a solucao de uma formiga (um conjunto de rotas)
+struct sSolucao {
+    vector<sRota> rotas;
+    int iCustoTotal = 0;
+};
+
+// Pedido de cancelamento compartilhado entre quem chama o resolvedor e as
+// threads do ACO e da busca local. Ao ser cancelada, a execucao termina na
+// proxima verificacao devolvendo a melhor solucao encontrada ate ali.
+struct sTokenCancelamento {
+    atomic<bool> bSolicitado{false};
+
+    void cancelar() { bSolicitado.store(true, memory_order_relaxed); }
+    bool bCancelado() const { return bSolicitado.load(memory_order_relaxed); }
+};
+
+// Alteracao nos servicos de uma instancia ja resolvida, usada pela
+// reotimizacao incremental. Os ids sao os da solucao anterior; os servicos
+// incluidos trazem ids que ainda nao aparecem nela.
+struct sDeltaServicos {
+    vector<sServico> vsAdicionados;
+    vector<int> viRemovidos;
+    vector<pair<int, int>> vparNovasDemandas; // (id, nova demanda)
+};
+
+// Politica de deposito de feromonio ao fim de cada iteracao
+enum ePoliticaDeposito {
+    DEPOSITO_TODAS,  // Ant System: toda formiga deposita 1/custo
+    DEPOSITO_RANK,   // AS-rank: as k melhores depositam (k - r + 1)/custo
+    DEPOSITO_TOP_K   // somente as k melhores depositam 1/custo
+};
+
+// Parametros de uma execucao do ACO. Todo o estado de uma execucao vem daqui,
+// o que permite execucoes simultaneas com parametros diferentes.
+struct sParametrosACO {
+    int iNumFormigas = 20;
+    int iNumIteracoes = 300;
+    double dInfluenciaFeromonio = 1.0;
+    double dInfluenciaHeuristica = 3.0;
+    double dTaxaEvaporacao = TAXA_EVAPORACAO_FEROMONIO;
+    int iVizinhosFeromonio = 24;   // candidatos com feromonio proprio por servico (0: todos)
+    ePoliticaDeposito ePolitica = DEPOSITO_TODAS;
+    int iTopK = 5;
+    int iNumThreads = 1;
+    double dGapAlvo = -1.0;        // encerra quando (custo - limitante)/limitante <= alvo; negativo desativa
+    int iLimitanteInferior = 0;    // limitante inferior usado pelo criterio de gap
+    int iEliteBuscaLocal = 0;          // busca local nas k melhores formigas de cada iteracao (0 desativa)
+    double dLimiteBuscaLocalMs = 50.0; // tempo maximo da busca local de elite por iteracao
+    bool bExibirProgresso = true;  // mensagens de parada no terminal
+    const sTokenCancelamento* pCancelamento = nullptr; // opcional
+    const sSolucao* pSolucaoInicial = nullptr; // partida quente: incumbente inicial e reforco do feromonio
+    double dReforcoSolucaoInicial = 1.0;       // deposito inicial nas ligacoes da solucao, relativo ao feromonio inicial
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "grafo.hpp"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include "caminhos_minimos.cpp"
+#include "rastreamento.cpp"
+
+using namespace std;
+
+// Confere a atualizacao dinamica de bAlterarCustoTransito contra um
+// Floyd-Warshall completo em grafos aleatorios (arestas e arcos, com ligacoes
+// paralelas), aplicando aumentos e reducoes de custo, inclusive para zero.
+// Depois de cada alteracao as distancias devem ser iguais as do
+// Floyd-Warshall e cada predecessor deve fechar um caminho minimo:
+// dist[i][pred] + direta(pred, j) == dist[i][j].
+//
+//   g++ -O2 teste_caminhos_minimos.cpp -o teste_caminhos_minimos
+//   ./teste_caminhos_minimos [--grafos N] [--alteracoes N] [--semente S]
+
+sGrafo criarGrafoAleatorio(mt19937& gen) {
+    sGrafo grafo;
+    int iNumVertices = uniform_int_distribution<int>(2, 14)(gen);
+    grafo.iNumVertices = iNumVertices;
+    uniform_int_distribution<int> vertice(1, iNumVertices), custo(0, 20);
+    int iNumLigacoes = uniform_int_distribution<int>(1, iNumVertices * 3)(gen);
+    for (int l = 0; l < iNumLigacoes; ++l) {
+        int iOrigem = vertice(gen), iDestino = vertice(gen);
+        if (iOrigem == iDestino)
+            continue;
+        if (gen() % 2)
+            grafo.vsArestas.push_back({(int)grafo.vsArestas.size() + 1, iOrigem, iDestino, custo(gen), 0, 0});
+        else
+            grafo.vsArcos.push_back({(int)grafo.vsArcos.size() + 1, iOrigem, iDestino, custo(gen), 0, 0});
+        // ligacao paralela a que acabou de entrar
+        if (gen() % 4 == 0) {
+            if (gen() % 2)
+                grafo.vsArestas.push_back({(int)grafo.vsArestas.size() + 1, iDestino, iOrigem, custo(gen), 0, 0});
+            else
+                grafo.vsArcos.push_back({(int)grafo.vsArcos.size() + 1, iOrigem, iDestino, custo(gen), 0, 0});
+        }
+    }
+    grafo.numArestas = (int)grafo.vsArestas.size();
+    grafo.numArcos = (int)grafo.vsArcos.size();
+    return grafo;
+}
+
+// Devolve uma descricao do primeiro problema encontrado (vazia se estiver tudo certo)
+string sConferirMatrizes(const sGrafo& grafo, const vector<vector<int>>& vviDistancias, const vector<vector<int>>& vviPredecessores) {
+    int iTamanho = grafo.iNumVertices + 1;
+    vector<vector<int>> vviDistanciasFw(iTamanho, vector<int>(iTamanho, INF)), vviPredecessoresFw(iTamanho, vector<int>(iTamanho, -1));
+    floydWarshall(grafo, iTamanho, vviDistanciasFw, vviPredecessoresFw);
+    for (int i = 1; i < iTamanho; ++i) {
+        for (int j = 1; j < iTamanho; ++j) {
+            string sPar = " em (" + to_string(i) + ", " + to_string(j) + ")";
+            if (vviDistancias[i][j] != vviDistanciasFw[i][j])
+                return "distancia " + to_string(vviDistancias[i][j]) + " != " + to_string(vviDistanciasFw[i][j]) + sPar;
+            if (i == j || vviDistancias[i][j] == INF)
+                continue;
+            int iPredecessor = vviPredecessores[i][j];
+            if (iPredecessor < 1 || iPredecessor >= iTamanho || vviDistancias[i][iPredecessor] == INF)
+                return "predecessor " + to_string(iPredecessor) + " invalido" + sPar;
+            int iDireta = iCustoLigacaoDireta(grafo, iPredecessor, j);
+            if (iDireta == INF || (long long)vviDistancias[i][iPredecessor] + iDireta != vviDistancias[i][j])
+                return "predecessor " + to_string(iPredecessor) + " fora do caminho minimo" + sPar;
+        }
+    }
+    return "";
+}
+
+int main(int iQtdArgumentos, char* vsArgumentos[]) {
+    int iNumGrafos = 200, iAlteracoesPorGrafo = 15;
+    unsigned iSemente = 42;
+    for (int i = 1; i + 1 < iQtdArgumentos; i += 2) {
+        string sArgumento = vsArgumentos[i];
+        if (sArgumento == "--grafos") iNumGrafos = atoi(vsArgumentos[i + 1]);
+        else if (sArgumento == "--alteracoes") iAlteracoesPorGrafo = atoi(vsArgumentos[i + 1]);
+        else if (sArgumento == "--semente") iSemente = (unsigned)atoi(vsArgumentos[i + 1]);
+    }
+
+    mt19937 gen(iSemente);
+    int iConferidas = 0, iFalhas = 0, iAumentos = 0, iReducoes = 0;
+    for (int g = 0; g < iNumGrafos; ++g) {
+        sGrafo grafo = criarGrafoAleatorio(gen);
+        if (grafo.vsArestas.empty() && grafo.vsArcos.empty())
+            continue;
+        int iTamanho = grafo.iNumVertices + 1;
+        vector<vector<int>> vviDistancias(iTamanho, vector<int>(iTamanho, INF)), vviPredecessores(iTamanho, vector<int>(iTamanho, -1));
+        floydWarshall(grafo, iTamanho, vviDistancias, vviPredecessores);
+
+        for (int a = 0; a < iAlteracoesPorGrafo; ++a) {
+            // sorteia uma ligacao existente; arestas podem vir em qualquer sentido
+            size_t iIndice = gen() % (grafo.vsArestas.size() + grafo.vsArcos.size());
+            bool bArco = iIndice >= grafo.vsArestas.size();
+            int iOrigem, iDestino, iCustoAntigo;
+            if (bArco) {
+                const sArco& arco = grafo.vsArcos[iIndice - grafo.vsArestas.size()];
+                iOrigem = arco.origem, iDestino = arco.destino, iCustoAntigo = arco.custoTransito;
+            } else {
+                const sAresta& aresta = grafo.vsArestas[iIndice];
+                iOrigem = aresta.origem, iDestino = aresta.destino, iCustoAntigo = aresta.custoTransito;
+                if (gen() % 2)
+                    swap(iOrigem, iDestino);
+            }
+            int iNovoCusto = gen() % 5 == 0 ? 0 : uniform_int_distribution<int>(0, 40)(gen);
+            (iNovoCusto > iCustoAntigo ? iAumentos : iReducoes)++;
+
+            if (!bAlterarCustoTransito(grafo, bArco, iOrigem, iDestino, iNovoCusto, vviDistancias, vviPredecessores)) {
+                cerr << "Grafo " << g << ": ligacao " << iOrigem << " -> " << iDestino << " nao encontrada" << endl;
+                return 1;
+            }
+            iConferidas++;
+            string sProblema = sConferirMatrizes(grafo, vviDistancias, vviPredecessores);
+            if (!sProblema.empty()) {
+                if (++iFalhas <= 10)
+                    cerr << "Grafo " << g << ", alteracao " << a << " (" << (bArco ? "arco " : "aresta ") << iOrigem << " -> "
+                         << iDestino << ": " << iCustoAntigo << " -> " << iNovoCusto << "): " << sProblema << endl;
+                break;
+            }
+        }
+    }
+
+    cout << iConferidas - iFalhas << " de " << iConferidas << " alteracoes conferidas (" << iAumentos << " aumentos, "
+         << iReducoes << " reducoes ou sem mudanca)" << endl;
+    return iFalhas == 0 ? 0 : 1;
+}
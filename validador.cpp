@@ -0,0 +1,226 @@
+#include "grafo.hpp"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "leitura.cpp"
+#include "caminhos_minimos.cpp"
+#include "cache_preprocessamento.cpp"
+#include "colonia_formigas.cpp"
+#include "metricas.cpp"
+#include "rastreamento.cpp"
+#include "leitura_solucao.cpp"
+#include "arquivosInstancia.hpp"
+
+using namespace std;
+
+// Validador das solucoes em solucoes/*.dat: confere cobertura dos servicos,
+// capacidade das rotas e recalcula os custos a partir da matriz de distancias.
+//
+// Uso: validador [--threads N] [--sem-cache] [instancia.dat ...]
+// Sem instancias na linha de comando, valida todas as de arquivosInstancia.hpp.
+
+const int MAX_DIVERGENCIAS_EXIBIDAS = 10;
+
+struct sResultadoValidacao {
+    string sArquivo;
+    bool bLido = false;
+    bool bViavel = true;          // cobertura, capacidade e estrutura das rotas
+    bool bCustosConferem = true;  // custos informados == custos recalculados
+    bool bCacheUsado = false;
+    long lCustoInformado = 0;
+    long lCustoRecalculado = 0;
+    int iNumRotas = 0;
+    int iNumDivergencias = 0;
+    vector<string> vsDivergencias;
+
+    void registrar(const string& sDivergencia) {
+        if (iNumDivergencias++ < MAX_DIVERGENCIAS_EXIBIDAS)
+            vsDivergencias.push_back(sDivergencia);
+    }
+};
+
+sResultadoValidacao validarSolucao(const string& sNomeInstancia, bool bUsarCache) {
+    sResultadoValidacao resultado;
+    resultado.sArquivo = "sol-" + sNomeInstancia;
+
+    sSolucaoLida solucao;
+    string sErro;
+    if (!bLerSolucaoDat("./solucoes/" + resultado.sArquivo, solucao, sErro)) {
+        resultado.registrar(sErro);
+        resultado.bViavel = false;
+        return resultado;
+    }
+
+    bool bConseguiuLerArquivo = false;
+    sGrafo grafo = sLerArquivo(sNomeInstancia, bConseguiuLerArquivo, false);
+    if (!bConseguiuLerArquivo) {
+        resultado.registrar("nao foi possivel ler a instancia " + sNomeInstancia);
+        resultado.bViavel = false;
+        return resultado;
+    }
+    resultado.bLido = true;
+
+    int iTamanho = grafo.iNumVertices + 1;
+    vector<vector<int>> vviDistancias, vviPredecessores;
+    resultado.bCacheUsado = bUsarCache && bCarregarCachePreprocessamento(grafo, vviDistancias, vviPredecessores);
+    if (!resultado.bCacheUsado) {
+        vviDistancias.assign(iTamanho, vector<int>(iTamanho, INF));
+        vviPredecessores.assign(iTamanho, vector<int>(iTamanho, -1));
+        floydWarshall(grafo, iTamanho, vviDistancias, vviPredecessores);
+        if (bUsarCache)
+            salvarCachePreprocessamento(grafo, vviDistancias, vviPredecessores);
+    }
+
+    auto distancia = [&](int iOrigem, int iDestino) -> long {
+        if (iOrigem < 1 || iOrigem >= iTamanho || iDestino < 1 || iDestino >= iTamanho)
+            return -1;
+        return vviDistancias[iOrigem][iDestino] == INF ? -1 : vviDistancias[iOrigem][iDestino];
+    };
+
+    vector<sServico> vsServicos = extrairServicos(grafo);
+    vector<int> viVezesAtendido(vsServicos.size(), 0);
+
+    resultado.lCustoInformado = solucao.lCustoTotal;
+    resultado.iNumRotas = (int)solucao.vsRotas.size();
+    if (solucao.iNumRotas != (int)solucao.vsRotas.size()) {
+        resultado.registrar("cabecalho informa " + to_string(solucao.iNumRotas) + " rotas, arquivo contem " +
+                            to_string(solucao.vsRotas.size()));
+        resultado.bViavel = false;
+    }
+
+    for (const sRotaLida& rota : solucao.vsRotas) {
+        string sRota = "rota " + to_string(rota.iId) + ": ";
+        const vector<sVisitaLida>& vsVisitas = rota.vsVisitas;
+        if (vsVisitas.size() < 2 || vsVisitas.front().cTipo != 'D' || vsVisitas.back().cTipo != 'D') {
+            resultado.registrar(sRota + "nao comeca e termina no deposito");
+            resultado.bViavel = false;
+            continue;
+        }
+        if ((int)vsVisitas.size() != rota.iVisitas) {
+            resultado.registrar(sRota + "informa " + to_string(rota.iVisitas) + " visitas, contem " +
+                                to_string(vsVisitas.size()));
+            resultado.bViavel = false;
+        }
+
+        long lDemanda = 0;
+        long lCusto = 0;
+        int iAtual = vsVisitas.front().iVertice2;
+        if (iAtual != grafo.deposito) {
+            resultado.registrar(sRota + "deposito " + to_string(iAtual) + " difere do deposito da instancia");
+            resultado.bViavel = false;
+        }
+        for (size_t v = 1; v + 1 < vsVisitas.size(); ++v) {
+            const sVisitaLida& visita = vsVisitas[v];
+            if (visita.cTipo != 'S' || visita.iId < 1 || visita.iId > (int)vsServicos.size()) {
+                resultado.registrar(sRota + "servico invalido " + to_string(visita.iId));
+                resultado.bViavel = false;
+                continue;
+            }
+            const sServico& servico = vsServicos[visita.iId - 1];
+            bool bMesmoSentido = visita.iVertice1 == servico.iVertice1 && visita.iVertice2 == servico.iVertice2;
+            bool bSentidoInverso = servico.bAresta && visita.iVertice1 == servico.iVertice2 && visita.iVertice2 == servico.iVertice1;
+            if (!bMesmoSentido && !bSentidoInverso) {
+                resultado.registrar(sRota + "servico " + to_string(visita.iId) + " com extremidades (" +
+                                    to_string(visita.iVertice1) + "," + to_string(visita.iVertice2) + "), esperado (" +
+                                    to_string(servico.iVertice1) + "," + to_string(servico.iVertice2) + ")");
+                resultado.bViavel = false;
+            }
+            viVezesAtendido[visita.iId - 1]++;
+            long lIda = distancia(iAtual, visita.iVertice1);
+            if (lIda < 0) {
+                resultado.registrar(sRota + "servico " + to_string(visita.iId) + " inalcancavel");
+                resultado.bViavel = false;
+                lIda = 0;
+            }
+            lCusto += lIda + servico.custo;
+            lDemanda += servico.demanda;
+            iAtual = visita.iVertice2;
+        }
+        long lVolta = distancia(iAtual, vsVisitas.back().iVertice1);
+        lCusto += max(lVolta, 0L);
+
+        if (lDemanda > grafo.capacidadeVeiculo) {
+            resultado.registrar(sRota + "demanda " + to_string(lDemanda) + " excede a capacidade " +
+                                to_string(grafo.capacidadeVeiculo));
+            resultado.bViavel = false;
+        }
+        if (lDemanda != rota.iDemanda) {
+            resultado.registrar(sRota + "demanda informada " + to_string(rota.iDemanda) + ", recalculada " + to_string(lDemanda));
+            resultado.bViavel = false;
+        }
+        if (lCusto != rota.iCusto) {
+            resultado.registrar(sRota + "custo informado " + to_string(rota.iCusto) + ", recalculado " + to_string(lCusto));
+            resultado.bCustosConferem = false;
+        }
+        resultado.lCustoRecalculado += lCusto;
+    }
+
+    for (size_t s = 0; s < viVezesAtendido.size(); ++s) {
+        if (viVezesAtendido[s] != 1) {
+            resultado.registrar("servico " + to_string(s + 1) + " atendido " + to_string(viVezesAtendido[s]) + " vezes");
+            resultado.bViavel = false;
+        }
+    }
+    if (resultado.lCustoRecalculado != resultado.lCustoInformado) {
+        resultado.registrar("custo total informado " + to_string(resultado.lCustoInformado) + ", recalculado " +
+                            to_string(resultado.lCustoRecalculado));
+        resultado.bCustosConferem = false;
+    }
+    return resultado;
+}
+
+int main(int iQtdArgumentos, char* vsArgumentos[]) {
+    int iNumThreads = max(1, (int)thread::hardware_concurrency());
+    bool bUsarCache = true;
+    vector<string> vsInstancias;
+    for (int iArgumento = 1; iArgumento < iQtdArgumentos; ++iArgumento) {
+        string sArgumento = vsArgumentos[iArgumento];
+        if (sArgumento == "--threads" && iArgumento + 1 < iQtdArgumentos)
+            iNumThreads = max(1, atoi(vsArgumentos[++iArgumento]));
+        else if (sArgumento == "--sem-cache")
+            bUsarCache = false;
+        else
+            vsInstancias.push_back(sArgumento);
+    }
+    if (vsInstancias.empty())
+        vsInstancias = vsArquivosTrabalho;
+
+    auto tInicio = chrono::steady_clock::now();
+    vector<sResultadoValidacao> vsResultados(vsInstancias.size());
+    atomic<size_t> iProximo(0);
+    auto trabalhar = [&]() {
+        size_t iIndice;
+        while ((iIndice = iProximo.fetch_add(1)) < vsInstancias.size())
+            vsResultados[iIndice] = validarSolucao(vsInstancias[iIndice], bUsarCache);
+    };
+    vector<thread> vThreads;
+    for (int t = 1; t < iNumThreads; ++t)
+        vThreads.emplace_back(trabalhar);
+    trabalhar();
+    for (auto& th : vThreads)
+        th.join();
+
+    int iValidas = 0;
+    for (const sResultadoValidacao& resultado : vsResultados) {
+        bool bOk = resultado.bViavel && resultado.bCustosConferem;
+        iValidas += bOk;
+        cout << (bOk ? "OK    " : "FALHA ") << resultado.sArquivo
+             << " | viavel: " << (resultado.bViavel ? "sim" : "nao")
+             << " | custo informado: " << resultado.lCustoInformado
+             << " | custo recalculado: " << resultado.lCustoRecalculado
+             << " | rotas: " << resultado.iNumRotas
+             << (resultado.bCacheUsado ? " | cache" : "") << endl;
+        for (const string& sDivergencia : resultado.vsDivergencias)
+            cout << "    - " << sDivergencia << endl;
+        if (resultado.iNumDivergencias > MAX_DIVERGENCIAS_EXIBIDAS)
+            cout << "    ... e mais " << resultado.iNumDivergencias - MAX_DIVERGENCIAS_EXIBIDAS << " divergencias" << endl;
+    }
+
+    double dSegundos = chrono::duration<double>(chrono::steady_clock::now() - tInicio).count();
+    cout << "\n" << iValidas << " de " << vsResultados.size() << " solucoes validas (" << dSegundos << " s, "
+         << iNumThreads << " threads)" << endl;
+    return iValidas == (int)vsResultados.size() ? 0 : 1;
+}
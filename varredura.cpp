@@ -0,0 +1,158 @@
+#include "grafo.hpp"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+// Modo de varredura de parametros: cada instancia e lida e pre-processada uma
+// unica vez e todas as configuracoes do ACO rodam em paralelo sobre a mesma
+// matriz de distancias (somente leitura).
+//
+// Formato da especificacao (uma chave por linha, '#' inicia comentario):
+//   formigas 10 20 40
+//   iteracoes 100 300
+//   alfa 1 2
+//   beta 2 3 5
+//   evaporacao 0.1 0.2
+//   amostras 20     (opcional: sorteia 20 configuracoes da grade em vez de todas)
+//   semente 42      (opcional: semente do sorteio)
+// Chaves ausentes usam o valor dos parametros base.
+
+struct sResultadoVarredura {
+    sParametrosACO parametros;
+    int iCustoACO = 0;
+    int iCustoFinal = 0;
+    double dTempoMs = 0.0;
+};
+
+bool bLerEspecificacaoVarredura(const string& sNomeArquivo, const sParametrosACO& base, vector<sParametrosACO>& vsConfiguracoes) {
+    ifstream arquivo(sNomeArquivo);
+    if (!arquivo.is_open()) {
+        cerr << "Erro ao abrir a especificacao de varredura: " << sNomeArquivo << endl;
+        return false;
+    }
+
+    vector<int> viFormigas = {base.iNumFormigas};
+    vector<int> viIteracoes = {base.iNumIteracoes};
+    vector<double> vdAlfa = {base.dInfluenciaFeromonio};
+    vector<double> vdBeta = {base.dInfluenciaHeuristica};
+    vector<double> vdEvaporacao = {base.dTaxaEvaporacao};
+    int iAmostras = 0;
+    unsigned int iSemente = random_device{}();
+
+    string sLinha;
+    while (getline(arquivo, sLinha)) {
+        sLinha = sLinha.substr(0, sLinha.find('#'));
+        stringstream ss(sLinha);
+        string sChave;
+        if (!(ss >> sChave)) continue;
+        vector<double> vdValores;
+        double dValor;
+        while (ss >> dValor) vdValores.push_back(dValor);
+        if (vdValores.empty()) {
+            cerr << "Chave sem valores na especificacao de varredura: " << sChave << endl;
+            return false;
+        }
+        if (sChave == "formigas") viFormigas.assign(vdValores.begin(), vdValores.end());
+        else if (sChave == "iteracoes") viIteracoes.assign(vdValores.begin(), vdValores.end());
+        else if (sChave == "alfa") vdAlfa = vdValores;
+        else if (sChave == "beta") vdBeta = vdValores;
+        else if (sChave == "evaporacao") vdEvaporacao = vdValores;
+        else if (sChave == "amostras") iAmostras = (int)vdValores[0];
+        else if (sChave == "semente") iSemente = (unsigned int)vdValores[0];
+        else {
+            cerr << "Chave desconhecida na especificacao de varredura: " << sChave << endl;
+            return false;
+        }
+    }
+
+    vsConfiguracoes.clear();
+    for (int iFormigas : viFormigas)
+        for (int iIteracoes : viIteracoes)
+            for (double dAlfa : vdAlfa)
+                for (double dBeta : vdBeta)
+                    for (double dEvaporacao : vdEvaporacao) {
+                        sParametrosACO parametros = base;
+                        parametros.iNumFormigas = iFormigas;
+                        parametros.iNumIteracoes = iIteracoes;
+                        parametros.dInfluenciaFeromonio = dAlfa;
+                        parametros.dInfluenciaHeuristica = dBeta;
+                        parametros.dTaxaEvaporacao = dEvaporacao;
+                        vsConfiguracoes.push_back(parametros);
+                    }
+
+    if (iAmostras > 0 && iAmostras < (int)vsConfiguracoes.size()) {
+        mt19937 gen(iSemente);
+        shuffle(vsConfiguracoes.begin(), vsConfiguracoes.end(), gen);
+        vsConfiguracoes.resize(iAmostras);
+    }
+    return true;
+}
+
+// Roda todas as configuracoes sobre a instancia ja pre-processada e grava a
+// tabela custo/tempo em sNomeArquivoSaida (CSV)
+vector<sResultadoVarredura> executarVarredura(
+												const sGrafo& grafo,
+												const vector<vector<int>>& vviDistancias,
+												const vector<sParametrosACO>& vsConfiguracoes,
+												int iNumThreads,
+												const string& sNomeArquivoSaida
+) {
+    vector<sResultadoVarredura> vsResultados(vsConfiguracoes.size());
+    atomic<size_t> iProxima(0);
+
+    // Cada configuracao roda em uma unica thread; o paralelismo e entre configuracoes
+    auto trabalhar = [&]() {
+        size_t iIndice;
+        while ((iIndice = iProxima.fetch_add(1)) < vsConfiguracoes.size()) {
+            sResultadoVarredura& resultado = vsResultados[iIndice];
+            resultado.parametros = vsConfiguracoes[iIndice];
+            resultado.parametros.iNumThreads = 1;
+            resultado.parametros.bExibirProgresso = false;
+
+            auto tInicio = chrono::steady_clock::now();
+            sSolucao solucao = executarACO(grafo, vviDistancias, resultado.parametros);
+            resultado.iCustoACO = solucao.iCustoTotal;
+            buscaLocal(solucao, vviDistancias, grafo.deposito, grafo.capacidadeVeiculo);
+            resultado.iCustoFinal = solucao.iCustoTotal;
+            resultado.dTempoMs = chrono::duration<double, milli>(chrono::steady_clock::now() - tInicio).count();
+        }
+    };
+
+    vector<thread> vThreads;
+    for (int t = 1; t < max(1, iNumThreads); ++t)
+        vThreads.emplace_back(trabalhar);
+    trabalhar();
+    for (auto& th : vThreads)
+        th.join();
+
+    ofstream arquivoSaida(sNomeArquivoSaida);
+    if (!arquivoSaida.is_open()) {
+        cerr << "Erro ao abrir o arquivo de saída!" << endl;
+        return vsResultados;
+    }
+    arquivoSaida << "configuracao,formigas,iteracoes,alfa,beta,evaporacao,custoACO,custoFinal,tempoMs\n";
+    for (size_t i = 0; i < vsResultados.size(); ++i) {
+        const sResultadoVarredura& resultado = vsResultados[i];
+        arquivoSaida << i + 1 << ","
+                     << resultado.parametros.iNumFormigas << ","
+                     << resultado.parametros.iNumIteracoes << ","
+                     << resultado.parametros.dInfluenciaFeromonio << ","
+                     << resultado.parametros.dInfluenciaHeuristica << ","
+                     << resultado.parametros.dTaxaEvaporacao << ","
+                     << resultado.iCustoACO << ","
+                     << resultado.iCustoFinal << ","
+                     << resultado.dTempoMs << "\n";
+    }
+    arquivoSaida.close();
+    cout << "Varredura salva em: " << sNomeArquivoSaida << endl;
+    return vsResultados;
+}